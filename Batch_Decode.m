@@ -0,0 +1,131 @@
+function results = Batch_Decode(capture_dir,out_file,rmc,rxOpts)
+% Batch_Decode Headless decoding of recorded captures on every core
+%   capture_dir : directory of *.iq recordings, int16 interleaved I/Q as written by the main scripts,
+%                 or *.iqp packed recordings (Record_Packed)
+%   out_file    : per-frame results, .parquet (columnar) or .csv
+%   rmc, rxOpts : cell configuration and receiver options, see Global_Parameters
+%   results     : table with one row per frame window
+% Every recording is split into two-frame windows, each holding one complete
+% frame. The windows are queued as independent jobs on the parallel pool and
+% collected with fetchNext, so idle workers take the next pending job.
+% A packed recording is deflated as a whole, so it is unpacked once into a
+% temporary .iq file and its jobs read their window from it.
+if nargin < 4
+    rxOpts = struct();
+end
+samplesPerFrame = 10e-3*rmc.SamplingRate;
+files = [dir(fullfile(capture_dir,'*.iq')); dir(fullfile(capture_dir,'*.iqp'))];
+pool = gcp();
+
+% Unpack the packed recordings, one pool job per recording
+paths = fullfile({files.folder},{files.name}).';
+dataPaths = paths;
+bits = 12*ones(length(files),1); % .iq recordings hold the 12-bit AD9361 samples
+unpackIdx = find(endsWith(paths,'.iqp'));
+for n = 1:length(unpackIdx)
+    dataPaths{unpackIdx(n)} = [tempname '.iq'];
+    unpacks(n) = parfeval(pool,@Unpack_File,1,paths{unpackIdx(n)},dataPaths{unpackIdx(n)}); %#ok<AGROW>
+end
+cleanup = onCleanup(@() Delete_Files(dataPaths(unpackIdx)));
+for n = 1:length(unpackIdx)
+    bits(unpackIdx(n)) = fetchOutputs(unpacks(n));
+end
+
+% Build the job list : one window of two frames per decodable frame
+jobFile = [];
+jobOffset = [];
+for f = 1:length(files)
+    d = dir(dataPaths{f});
+    numSamples = d.bytes/4; % int16 I + int16 Q
+    for k = 0:floor(numSamples/samplesPerFrame)-2
+        jobFile(end+1,1) = f; %#ok<AGROW>
+        jobOffset(end+1,1) = k*samplesPerFrame; %#ok<AGROW>
+    end
+end
+numJobs = length(jobOffset);
+fprintf('Batch_Decode : %d frame jobs from %d recordings\n',numJobs,length(files));
+if numJobs == 0
+    results = table();
+    return;
+end
+
+% Queue the jobs, results are collected in completion order
+futures(numJobs,1) = parallel.FevalFuture;
+for n = 1:numJobs
+    f = jobFile(n);
+    futures(n) = parfeval(pool,@Decode_Job,1,paths{f},dataPaths{f},bits(f), ...
+        jobOffset(n),2*samplesPerFrame,rmc,rxOpts);
+end
+rows = cell(numJobs,1);
+t_start = tic;
+for n = 1:numJobs
+    [idx,row] = fetchNext(futures);
+    rows{idx} = row;
+end
+elapsed = toc(t_start);
+results = struct2table(vertcat(rows{:}));
+fprintf('Batch_Decode : %.2f frames/s, %.2f MS/s on %d workers\n',numJobs/elapsed, ...
+    numJobs*2*samplesPerFrame/elapsed/1e6,pool.NumWorkers);
+
+% Columnar output
+[~,~,ext] = fileparts(out_file);
+if strcmp(ext,'.parquet')
+    parquetwrite(out_file,results);
+else
+    writetable(results,out_file);
+end
+end
+
+function bits = Unpack_File(file,iq_file)
+% Unpack a packed recording into an int16 interleaved I/Q file, returns its sample bits
+fid = fopen(file,'r');
+% Header : sample count, bits, shift, compressed ; then the packed stream
+hdr = fread(fid,4,'uint32');
+fmt = struct('bits',hdr(2),'shift',hdr(3));
+samples = Unpack_Samples(fread(fid,inf,'uint8=>uint8'),hdr(1),fmt,hdr(4));
+fclose(fid);
+fid = fopen(iq_file,'w');
+fwrite(fid,samples,'int16');
+fclose(fid);
+bits = fmt.bits;
+end
+
+function Delete_Files(files)
+for k = 1:length(files)
+    if exist(files{k},'file')
+        delete(files{k});
+    end
+end
+end
+
+function row = Decode_Job(file,iq_file,bits,offset,len,rmc,rxOpts)
+% Decode the frame of one capture window, read from the int16 I/Q file iq_file
+row = struct('File',string(file),'Offset',offset,'NCellID',NaN,'NFrame',NaN, ...
+    'CFO_Hz',NaN,'Timing',NaN,'CRC_Pass',0,'CRC_Fail',0,'EVM_pct',NaN,'SNR_dB',NaN);
+fid = fopen(iq_file,'r');
+fseek(fid,offset*4,'bof');
+samples = fread(fid,[2 len],'int16=>int16');
+fclose(fid);
+try
+    iq_corr = IQ_Correction;
+    iq_corr.full_scale = 2^(bits-1);
+    rxWaveform = iq_corr.step(samples(1,:).',samples(2,:).');
+    fe = OFDM_RX_FrontEnd(rxWaveform,rmc);
+    if ~fe.found(1)
+        return; % Configured cell not found, NaN results
+    end
+    res = OFDM_RX_Decode(rmc,fe.rxGrid{fe.gridIdx(1)},rxOpts);
+    row.NCellID = fe.NCellID(1);
+    row.NFrame = res.recFrames(1);
+    row.CFO_Hz = fe.frequencyOffset;
+    row.Timing = fe.frameOffset(1);
+    row.CRC_Pass = sum(res.blkcrc(:) == 0);
+    row.CRC_Fail = sum(res.blkcrc(:) == 1);
+    if sum(res.evmSF(:,2)) > 0
+        row.EVM_pct = 100*sqrt(sum(res.evmSF(:,1))/sum(res.evmSF(:,2)));
+        row.SNR_dB = mean(res.snrSF(~isnan(res.snrSF)));
+    end
+catch
+    % Undecodable window, keep the row with NaN results
+end
+end
@@ -0,0 +1,102 @@
+clear;close all;clc;
+Global_Parameters;
+%% Benchmark Parameters
+SNR_dB = [10 15 20 25 30];    % AWGN SNR points [dB]
+Num_Trials = 3;               % Captures per SNR point
+Channel.CFO = 500;            % Carrier frequency offset [Hz]
+Channel.TimingOffset = 20000; % Start of the first frame in the first capture [samples]
+Channel.CaptureAdvance = 1000; % Samples between consecutive capture starts, not a frame multiple
+Channel.Multipath = [1 0 0.3*exp(0.5i) 0 0.1]; % Tap gains at the sample spacing
+Baseline_File = 'benchmark_baseline.mat';
+Regression_Tolerance = 0.2;   % Flag stages more than 20% slower than the baseline
+rng(2018);                    % Reproducible payload and noise
+%% Transmitter : R.7 10 MHz frame with a random payload
+tracer = Trace_Recorder.instance();
+tracer.reset();
+trData = randi([0 1],sum(rmc.PDSCH.TrBlkSizes(:)),1);
+t = Trace_Recorder.begin();
+txdata = OFDM_TX_Waveform(rmc,trData);
+Trace_Recorder.finish('TX/waveform', t);
+samplesPerFrame = length(txdata);
+%% Channel and receiver
+crcPass = zeros(length(SNR_dB),1);
+crcTotal = zeros(length(SNR_dB),1);
+chainTime = 0;
+numCaptures = 0;
+iq_corr = IQ_Correction;
+rx_tracker = RX_Tracker;
+rx_tracker.capture_advance = Channel.CaptureAdvance; % Exercises the tracking window prediction
+for k = 1:length(SNR_dB)
+    for trial = 1:Num_Trials
+        % Two frames of the cyclic TX buffer, as in one 307200-sample capture
+        x = repmat(double(txdata)*2^-15,2,1);
+        x = circshift(x,Channel.TimingOffset-numCaptures*Channel.CaptureAdvance); % Contiguous captures
+        x = filter(Channel.Multipath,1,x);
+        x = x.*exp(1i*2*pi*Channel.CFO/rmc.SamplingRate*(0:length(x)-1).');
+        x = awgn(x,SNR_dB(k),'measured');
+        % 12-bit ADC samples in 16-bit words
+        scale = 2^11*0.5/max(abs([real(x);imag(x)]));
+        i_in = int16(max(min(round(real(x)*scale),2047),-2048));
+        q_in = int16(max(min(round(imag(x)*scale),2047),-2048));
+
+        t_chain = tic;
+        t = Trace_Recorder.begin();
+        rxWaveform = iq_corr.step(i_in,q_in);
+        Trace_Recorder.finish('OFDM_RX/iq_correct', t);
+        fe = OFDM_RX_FrontEnd(rxWaveform,rmc,rx_tracker);
+        if ~fe.found(1)
+            crcTotal(k) = crcTotal(k) + 9; % Cell not found, no subframe decoded
+            chainTime = chainTime + toc(t_chain);
+            numCaptures = numCaptures + 1;
+            continue;
+        end
+        hints = rx_tracker.decodeHints(fe,rmc);
+        res = OFDM_RX_Decode(rmc,fe.rxGrid{fe.gridIdx(1)},rxOpts,hints{1});
+        rx_tracker.update(fe,{res},fe.tracked);
+        chainTime = chainTime + toc(t_chain);
+        numCaptures = numCaptures + 1;
+
+        crc = res.blkcrc(~isnan(res.blkcrc));
+        crcPass(k) = crcPass(k) + sum(crc == 0);
+        crcTotal(k) = crcTotal(k) + 9; % Data subframes per frame
+    end
+end
+%% Report
+fprintf('\n===== TX/RX chain benchmark =====\n');
+fprintf('Throughput      : %.3f MS/s (%d samples per capture)\n',numCaptures*2*samplesPerFrame/chainTime/1e6,2*samplesPerFrame);
+fprintf('Frames          : %.2f frames/s\n',numCaptures/chainTime);
+fprintf('Decode          : %.1f us per subframe\n',chainTime/numCaptures/9*1e6);
+fprintf('Acquisitions    : %d of %d captures\n',rx_tracker.acquisitions,numCaptures);
+if rx_tracker.acquisitions > 1
+    fprintf(2,'TRACKING the tracker lost lock with a %d-sample capture advance\n',Channel.CaptureAdvance);
+end
+fprintf('Buffers         : %d symbols per capture, %d bits per frame (high-water marks)\n',res.hwm.symbols,res.hwm.bits);
+fprintf('Capture memory  : %d bytes int16, %d bytes complex double\n',2*numel(i_in)*2,numel(rxWaveform)*16);
+for k = 1:length(SNR_dB)
+    fprintf('SNR %5.1f dB    : %3d/%3d subframes decoded\n',SNR_dB(k),crcPass(k),crcTotal(k));
+end
+stages = tracer.summary();
+fprintf('\n%-32s %8s %12s %12s\n','stage','count','mean [us]','p99 [us]');
+for k = 1:length(stages)
+    fprintf('%-32s %8d %12.1f %12.1f\n',stages(k).stage,stages(k).count,stages(k).mean_us,stages(k).p99_us);
+end
+%% Baseline comparison
+if exist(Baseline_File,'file')
+    baseline = load(Baseline_File);
+    regressions = 0;
+    for k = 1:length(stages)
+        b = find(strcmp({baseline.stages.stage},stages(k).stage),1);
+        if ~isempty(b) && stages(k).mean_us > (1+Regression_Tolerance)*baseline.stages(b).mean_us
+            fprintf(2,'REGRESSION %-32s %12.1f us (baseline %.1f us)\n',stages(k).stage,stages(k).mean_us,baseline.stages(b).mean_us);
+            regressions = regressions + 1;
+        end
+    end
+    if any(crcPass < baseline.crcPass)
+        fprintf(2,'REGRESSION decode success below the baseline\n');
+        regressions = regressions + 1;
+    end
+    fprintf('\n%d regressions against %s\n',regressions,Baseline_File);
+else
+    save(Baseline_File,'stages','crcPass','SNR_dB');
+    fprintf('\nBaseline saved to %s\n',Baseline_File);
+end
@@ -0,0 +1,45 @@
+clear;close all;clc;j=1i;
+Global_Parameters;
+%% Benchmark Parameters
+IP = '192.168.3.7';
+Hop_Frequencies = CenterFrequency + (0:3)*20e6; % Hop set [Hz]
+Hop_Rounds = 5;        % The first round tunes every frequency, later rounds recall the cached profiles
+Settle_Tolerance = 1;  % Captures are valid once the power of two consecutive captures agrees within [dB]
+Max_Captures = 20;
+%% Hardware setting
+[s,input] = iio_Hardware_setting(IP,0,CenterFrequency,rmc);
+output = stepImpl(s, input); % Apply the configuration
+rxFormat = s.getOutDataFormat();
+full_scale = 2^(rxFormat.bits-1); % Capture sample full scale, as IQ_Correction
+% stepImpl rewrites every non-empty configuration input, leave the LOs to the hopper
+input{s.getInChannel('RX_LO_FREQ')} = [];
+input{s.getInChannel('TX_LO_FREQ')} = [];
+hop = LO_Hopping(s);
+hop.schedule = Hop_Frequencies;
+%% Retune-to-valid-samples latency
+latency = zeros(Hop_Rounds,length(Hop_Frequencies));
+captures = zeros(Hop_Rounds,length(Hop_Frequencies));
+for r = 1:Hop_Rounds
+    for k = 1:length(Hop_Frequencies)
+        t_start = tic;
+        [freq,method] = hop.next();
+        prevPower = NaN;
+        for n = 1:Max_Captures
+            output = stepImpl(s, input);
+            rxPower = pow2db(mean(abs(complex(double(output{1}),double(output{2}))/full_scale).^2));
+            if abs(rxPower-prevPower) < Settle_Tolerance
+                break;
+            end
+            prevPower = rxPower;
+        end
+        latency(r,k) = toc(t_start);
+        captures(r,k) = n;
+        fprintf('Round %i : %7.2f MHz (%s) valid after %i captures, %.1f ms\n',r,freq/1e6,method,n,latency(r,k)*1e3);
+    end
+end
+%% Report
+fprintf('\nFull retune     : mean %.1f ms\n',mean(latency(1,:))*1e3);
+if Hop_Rounds > 1
+    fprintf('Fastlock recall : mean %.1f ms, max %.1f ms\n',mean(mean(latency(2:end,:)))*1e3,max(max(latency(2:end,:)))*1e3);
+end
+s.releaseImpl();
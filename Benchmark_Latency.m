@@ -0,0 +1,97 @@
+clear;close all;clc;
+Global_Parameters;
+%% Benchmark Parameters
+TX_IP = '192.168.3.6';
+RX_IP = '192.168.3.7';
+Capture_Sizes = [307200 153600 76800 38400]; % RX buffer sizes swept [samples], out_ch_size
+Num_Pushes = 20;          % TX pushes per buffer size
+Max_Captures = 10;        % Captures searched for the marker of a push
+Gap_Tolerance = 1;        % Marker spacing error still counted as continuous [samples]
+%% TX waveform with markers
+load('Picture_all.mat');
+txFrame = Picture_all(1).txdata;
+marker = Latency_Marker(15360); % One marker per ms, 10 per frame
+fs = rmc.SamplingRate;
+%% Hardware setting
+% The TX board captures on every stepImpl as well, keep its capture short
+[s,input] = iio_Hardware_setting(TX_IP,txFrame,CenterFrequency,rmc,8192); % TX
+%% Latency per stage and buffer size
+% TX push   : stepImpl of the TX board (buffer create, copy, push)
+% Air + DMA : end of the push to the capture time of the first marker sample
+% Refill    : capture time of the marker to the end of the RX refill
+%             The capture time is modelled from the refill end, assuming the
+%             refill returned the block that just finished filling. The RX
+%             buffer persists, so an older queued block shifts the split
+%             between these two stages; their sum is measured.
+% Decode    : front end and decoding of the capture, NaN when the capture is
+%             too short to hold a frame (Total is then NaN as well)
+stages = {'TX push','Air + DMA','Refill','Decode','Total'};
+lat = NaN(Num_Pushes,length(stages),length(Capture_Sizes));
+overruns = zeros(1,length(Capture_Sizes));
+t_ref = tic;
+for b = 1:length(Capture_Sizes)
+    % releaseImpl deletes the libiio objects, the RX board is set up again for every size
+    [s2,input2] = iio_Hardware_setting(RX_IP,0,CenterFrequency,rmc,Capture_Sizes(b)); % RX
+    stepImpl(s2, input2); % Apply the configuration
+    rxFormat = s2.getOutDataFormat();
+    iq_corr = IQ_Correction; % Same scaling and correction as the receiver of Main_TwoBoard
+    iq_corr.full_scale = 2^(rxFormat.bits-1);
+    for push = 1:Num_Pushes
+        txdata = marker.embed(txFrame,push);
+        input{1} = real(txdata);
+        input{2} = imag(txdata);
+        t_push = toc(t_ref);
+        stepImpl(s, input);
+        t_pushed = toc(t_ref);
+        for n = 1:Max_Captures
+            output2 = stepImpl(s2, input2);
+            t_refilled = toc(t_ref);
+            [push_mod,pos,gaps] = marker.detect(complex(output2{1},output2{2}));
+            overruns(b) = overruns(b) + any(abs(gaps) > Gap_Tolerance);
+            if push_mod == mod(push,length(marker.roots))
+                break;
+            end
+        end
+        if push_mod ~= mod(push,length(marker.roots))
+            fprintf(2,'Buffer %d : marker of push %d not found\n',Capture_Sizes(b),push);
+            continue;
+        end
+        t_sample = t_refilled - (Capture_Sizes(b)-pos)/fs; % Capture time of the first marker sample
+        t = tic;
+        rxWaveform = iq_corr.step(output2{1},output2{2});
+        t_decode = NaN;
+        if Capture_Sizes(b) >= 2*153600 % Shorter captures may not hold a complete frame, decode is not timed
+            fe = OFDM_RX_FrontEnd(rxWaveform,rmc);
+            if fe.found(1) % Not timed when the cell search missed the cell
+                OFDM_RX_Decode(rmc,fe.rxGrid{fe.gridIdx(1)},rxOpts);
+                t_decode = toc(t);
+            end
+        end
+        lat(push,:,b) = [t_pushed-t_push t_sample-t_pushed t_refilled-t_sample t_decode t_refilled+t_decode-t_push];
+    end
+    s2.releaseImpl();
+end
+s.releaseImpl();
+%% Report
+for b = 1:length(Capture_Sizes)
+    fprintf('\nRX buffer %6d samples (%.1f ms), %d overruns\n',Capture_Sizes(b),Capture_Sizes(b)/fs*1e3,overruns(b));
+    fprintf('%-12s %10s %10s %10s\n','stage','p50 [ms]','p90 [ms]','max [ms]');
+    for k = 1:length(stages)
+        x = sort(lat(~isnan(lat(:,k,b)),k,b))*1e3;
+        if isempty(x)
+            continue;
+        end
+        fprintf('%-12s %10.2f %10.2f %10.2f\n',stages{k},x(ceil(0.5*end)),x(ceil(0.9*end)),x(end));
+    end
+end
+fprintf('\nAir + DMA / Refill split modelled from the refill end, their sum is measured\n');
+% Lowest median push-to-capture latency (TX push + Air + DMA + Refill) without overruns,
+% the decode is only timed for the longest captures and is left out of the comparison
+capture = squeeze(median(sum(lat(:,1:3,:),2),1,'omitnan'));
+capture(overruns > 0) = Inf;
+[best,b] = min(capture);
+if isfinite(best)
+    fprintf('\nBest setting : out_ch_size = %d, median %.2f ms from TX push to capture\n',Capture_Sizes(b),best*1e3);
+else
+    fprintf(2,'\nEvery buffer size overran\n');
+end
\ No newline at end of file
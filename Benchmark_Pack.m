@@ -0,0 +1,33 @@
+clear;close all;clc;
+%% Benchmark Parameters
+Num_Samples = 307200;            % Complex samples per capture
+Link_Rate = [100e6 1e9];         % Link rates [bit/s]
+Num_Trials = 10;
+fmt = struct('length',16,'bits',12,'shift',0,'is_signed',1); % cf-ad9361-lpc sample format
+rng(2018);
+%% Synthetic capture : OFDM-like Gaussian samples at -15 dBFS
+samples = int16(max(min(round(randn(2*Num_Samples,1)*2^11*10^(-15/20)/sqrt(2)),2047),-2048));
+%% Pack / unpack throughput
+modes = {'16-bit',0,16; '12-bit',0,12; '12-bit + deflate',1,12};
+for m = 1:size(modes,1)
+    f = fmt;
+    f.bits = modes{m,3};
+    t = tic;
+    for n = 1:Num_Trials
+        packed = Pack_Samples(samples,f,modes{m,2});
+    end
+    t_pack = toc(t)/Num_Trials;
+    t = tic;
+    for n = 1:Num_Trials
+        restored = Unpack_Samples(packed,numel(samples),f,modes{m,2});
+    end
+    t_unpack = toc(t)/Num_Trials;
+    assert(isequal(restored,samples),'Pack_Samples round trip mismatch');
+    bitsPerSample = 8*numel(packed)/Num_Samples; % Per complex sample
+    fprintf('%-18s : %5.2f bit/sample, pack %7.1f MS/s, unpack %7.1f MS/s',modes{m,1},bitsPerSample, ...
+        Num_Samples/t_pack/1e6,Num_Samples/t_unpack/1e6);
+    for l = 1:length(Link_Rate)
+        fprintf(', %g Mbit/s link %6.2f MS/s',Link_Rate(l)/1e6,Link_Rate(l)/bitsPerSample/1e6);
+    end
+    fprintf('\n');
+end
\ No newline at end of file
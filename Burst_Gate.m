@@ -0,0 +1,124 @@
+classdef Burst_Gate < handle
+    % Burst_Gate Energy / PSS detection gating of captures before the decoder
+    %   The power of each block of block_size samples is computed on the
+    %   int16 capture. When the capture shows both quiet and active blocks
+    %   it is forwarded to the decoder only if the longest run of active
+    %   blocks is long enough for one frame (min_active samples). A capture
+    %   without power contrast is either noise or a continuous transmission
+    %   (the AGC levels both), it is then forwarded only when the PSS of one
+    %   of the configured cells is found. The counters report the fraction of
+    %   the captured samples that did not reach the decoder.
+
+    properties (Access = public)
+        %enable 0 : forward every capture
+        enable = 1;
+
+        %block_size Samples per power detection block
+        block_size = 1024;
+
+        %threshold_db Active block threshold above the quietest block [dB]
+        threshold_db = 6;
+
+        %min_active Minimum run of active samples for a capture to be decoded (one frame)
+        min_active = 153600;
+
+        %min_peak_ratio Minimum PSS correlation peak to mean power ratio
+        min_peak_ratio = 20;
+    end
+
+    properties (SetAccess = private)
+        %active Active blocks of the last capture
+        active = [];
+
+        %captures Captures seen
+        captures = 0;
+
+        %forwarded Captures forwarded to the decoder
+        forwarded = 0;
+
+        %samples Samples seen
+        samples = 0;
+
+        %skipped_samples Samples of the skipped captures
+        skipped_samples = 0;
+    end
+
+    properties (Access = private)
+        pss = {};   % Time domain PSS of each distinct NID2 of the configured cells
+    end
+
+    methods
+        function obj = Burst_Gate(rmc)
+            % rmc : struct array of the cells to detect
+            for nid2 = unique(mod([rmc.NCellID], 3))
+                enb = rmc(1);
+                enb.NCellID = nid2;
+                enb.NSubframe = 0;
+                enb.CellRefP = 1;
+                grid = lteDLResourceGrid(enb);
+                grid(ltePSSIndices(enb)) = ltePSS(enb);
+                wf = lteOFDMModulate(enb, grid);
+                nz = find(wf ~= 0);
+                obj.pss{end+1} = wf(nz(1) : nz(end));
+            end
+        end
+
+        function pass = step(obj, i_in, q_in)
+            % Returns 1 when the capture holds a burst and has to be decoded
+            t = Trace_Recorder.begin();
+            n = floor(length(i_in)/obj.block_size)*obj.block_size;
+            x_i = double(i_in(1:n));
+            x_q = double(q_in(1:n));
+            power = mean(reshape(x_i.^2 + x_q.^2, obj.block_size, []), 1);
+            obj.active = power > max(min(power), 1)*10^(obj.threshold_db/10);
+            if(any(obj.active) && ~all(obj.active))
+                % Bursty capture : longest run of active blocks
+                d = diff([0 obj.active(:).' 0]);
+                run = max(find(d == -1) - find(d == 1))*obj.block_size;
+                pass = run >= obj.min_active;
+            else
+                % No power contrast : look for the PSS
+                pass = findPSS(obj, complex(x_i, x_q));
+            end
+            pass = pass || ~obj.enable;
+
+            obj.captures = obj.captures + 1;
+            obj.samples = obj.samples + length(i_in);
+            if(pass)
+                obj.forwarded = obj.forwarded + 1;
+            else
+                obj.skipped_samples = obj.skipped_samples + length(i_in);
+                Trace_Recorder.count('captures_skipped', 1);
+            end
+            Trace_Recorder.finish('OFDM_RX/burst_gate', t);
+        end
+
+        function f = skippedFraction(obj)
+            % Fraction of the captured samples not forwarded to the decoder
+            f = obj.skipped_samples/max(obj.samples, 1);
+        end
+
+        function report(obj)
+            % Print the gating counters
+            fprintf('Burst gate : %d of %d captures decoded, %.1f %% of the samples skipped\n', ...
+                obj.forwarded, obj.captures, 100*skippedFraction(obj));
+        end
+    end
+
+    methods (Access = private)
+        function found = findPSS(obj, x)
+            % FFT correlation with the PSS of each NID2, peak to mean power test
+            found = 0;
+            nfft = 2^nextpow2(length(x));
+            X = fft(x, nfft);
+            for k = 1 : length(obj.pss)
+                m = abs(ifft(X .* conj(fft(obj.pss{k}, nfft)))).^2;
+                m = m(1 : length(x) - length(obj.pss{k}));
+                if(max(m) > obj.min_peak_ratio*mean(m))
+                    found = 1;
+                    return;
+                end
+            end
+        end
+    end
+end
\ No newline at end of file
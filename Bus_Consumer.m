@@ -0,0 +1,50 @@
+function Bus_Consumer(role,consumer,bus_name)
+% Bus_Consumer Process reading the captures published by Capture_Daemon
+%   role     : 'decode' (OFDM_RX), 'psd' (Welch PSD monitor) or 'record' (.iq files in the current folder)
+%   consumer : consumer index on the bus, 1..8, one per running consumer
+%   bus_name : shared-memory name, default 'sdr_lte_bus'
+% Each consumer keeps its own cursor : a slow consumer loses captures, it never stalls the daemon.
+if nargin < 3
+    bus_name = 'sdr_lte_bus';
+end
+Global_Parameters;
+bus = Sample_Bus(bus_name,consumer);
+figure('Name',['Bus consumer : ',role],'NumberTitle','off');
+button = uicontrol;
+set(button,'String','Stop !','Position',[200 15 100 60]);
+set(button,'Callback','set(gcbo,''UserData'',1)');
+iq_corr = IQ_Correction; % Default full_scale : 12-bit samples of Capture_Daemon
+rx_tracker = RX_Tracker;
+gate = Burst_Gate(rxCells);
+captures = 0;
+while isempty(get(button,'UserData'))
+    [ok,i_in,q_in,rssi] = bus.next(1);
+    if ~ok
+        drawnow;
+        continue;
+    end
+    captures = captures + 1;
+    try
+        switch role
+            case 'decode'
+                if gate.step(i_in,q_in)
+                    OFDM_RX(iq_corr.step(i_in,q_in),rxCells,rssi,rxOpts,rx_tracker);
+                end
+            case 'psd'
+                [Spectrum_waveform,Welch_Spectrum_frequency] = pwelch(complex(double(i_in),double(q_in))/iq_corr.full_scale, ...
+                    [],[],[],rmc.SamplingRate,'centered','power');
+                plot(Welch_Spectrum_frequency,pow2db(Spectrum_waveform));
+                title(['Welch Power Spectral Density , RSSI = ',num2str(rssi),' , lost = ',num2str(bus.lost)]);
+            case 'record'
+                fid = fopen(sprintf('capture_%06d.iq',captures),'w');
+                fwrite(fid,[i_in q_in].','int16');
+                fclose(fid);
+        end
+    catch
+        disp(lasterr);
+    end
+    drawnow;
+end
+close(gcf);
+bus.report();
+end
\ No newline at end of file
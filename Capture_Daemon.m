@@ -0,0 +1,62 @@
+clear;close all;clc;
+Global_Parameters;
+%% Capture daemon : the only process owning the board buffers, captures are published on the sample bus
+Bus_Name = 'sdr_lte_bus';     % /dev/shm/sdr_lte_bus
+Bus_Slots = 16;               % Captures held by the ring
+IP = '192.168.3.6';
+%% Button setting
+figure('Name','Capture Daemon','NumberTitle','off');
+button = uicontrol; % Generate GUI button
+set(button,'String','Stop !','Position',[200 15 100 60]); % Add "Stop !" text
+set(button,'Callback','setstate0'); % Set the reaction of pushing button
+%% Hardware and bus
+state = 1; % status Start
+index = 1;
+[s,input] = iio_Hardware_setting(IP,zeros(153600,1),CenterFrequency,rmc);
+wfl = [];
+if exist('Picture_all.wfl','file')
+    wfl = Waveform_Library('Picture_all.wfl'); % TX waveforms, interleaved in DAC scan order
+end
+if isempty(wfl) || wfl.scan_elm_no ~= s.getTxScanElements() % Built for the scan elements of the opened DAC
+    load('Picture_all.mat');
+    Waveform_Library.build('Picture_all.wfl',{Picture_all.txdata},s.getTxScanElements());
+    wfl = Waveform_Library('Picture_all.wfl');
+end
+Runtime_Scheduling(sched); % CPU pinning and priority of the capture thread
+agc = Gain_Control; % Host-side RX gain control
+rxFormat = s.getOutDataFormat();
+agc.full_scale = 2^(rxFormat.bits-1);
+% Written directly, the stepImpl inputs stay empty so the gain is not rewritten per capture
+s.writeCfgChannel('RX1_GAIN_MODE','manual');
+s.writeCfgChannel('RX1_GAIN',agc.setLO(CenterFrequency));
+input{s.getInChannel('RX1_GAIN_MODE')} = [];
+input{s.getInChannel('RX1_GAIN')} = [];
+s.flushCapture(); % Captures queued with the automatic gain are dropped
+bus = Sample_Bus(Bus_Name,0,Bus_Slots,s.out_ch_size);
+fprintf('Publishing captures on /dev/shm/%s, start the consumers with Bus_Consumer\n',Bus_Name);
+
+while(state==1)
+    try
+        input{1} = wfl.get(index);
+        input{2} = [];
+        output = stepImpl(s, input);
+        rssi = output{s.getOutChannel('RX1_RSSI')};
+        bus.publish(output{1},output{2},rssi);
+        [gain,changed] = agc.update(output{1},output{2},rssi); % Gain for the next capture
+        if changed
+            s.writeCfgChannel('RX1_GAIN',gain);
+            s.flushCapture(); % The next capture is taken with the new gain
+        end
+        index = mod(index,wfl.count)+1;
+        drawnow; % Button callback
+    catch
+        ErrorMessage = lasterr;
+        fprintf('Error Message : \n');
+        disp(ErrorMessage);
+    end % try Loop
+end % While
+
+s.releaseImpl();
+close all;
+bus.report();
+disp('Software Complete');state = 0;
\ No newline at end of file
@@ -0,0 +1,19 @@
+function y = FIR_Channelize(x,Fs_in,f_offset,Fs_out,h)
+% FIR_Channelize Extract several narrow channels from one wide capture
+%   x        : capture sampled at Fs_in
+%   f_offset : channel centre frequencies relative to the capture centre [Hz]
+%   Fs_out   : output rate of every channel, Fs_in*p/q for integers p and q
+%   h        : optional prototype lowpass, e.g. ftr = ftr_read('LTE10_MHz.ftr'); h = ftr.rx.coef;
+%   y        : one column per channel
+if nargin < 5
+    h = [];
+end
+[p,q] = rat(Fs_out/Fs_in);
+n = (0:size(x,1)-1).';
+y = zeros(ceil(size(x,1)*p/q),length(f_offset));
+for c = 1:length(f_offset)
+    % Shift the channel to baseband, then filter and decimate
+    xc = x(:,1).*exp(-1i*2*pi*f_offset(c)/Fs_in*n);
+    y(:,c) = FIR_Resample(xc,p,q,double(h));
+end
+end
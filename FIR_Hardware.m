@@ -0,0 +1,10 @@
+function y = FIR_Hardware(x,fir,direction)
+% FIR_Hardware Model of the AD9361 programmable FIR loaded from a .ftr file
+%   fir       : structure returned by ftr_read
+%   direction : 'TX' interpolates by INT, 'RX' decimates by DEC
+if strcmp(direction,'TX')
+    y = upfirdn(x,fir.tx.h,fir.tx.rate,1);
+else
+    y = upfirdn(x,fir.rx.h,1,fir.rx.rate);
+end
+end
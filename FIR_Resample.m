@@ -0,0 +1,18 @@
+function y = FIR_Resample(x,p,q,h)
+% FIR_Resample Polyphase rational resampling of x by p/q
+%   h : prototype lowpass at the rate p*Fs_in. The taps are normalised to a
+%       passband gain of p. If h is omitted, a windowed sinc is designed.
+%   y : resampled signal, compensated for the group delay of h
+if nargin < 4 || isempty(h)
+    h = fir1(20*max(p,q), 1/max(p,q));
+end
+h = h(:) / sum(h) * p;
+
+% upfirdn runs the polyphase decomposition, only the needed outputs are computed
+y = upfirdn(x,h,p,q);
+
+% Remove the filter delay and trim to the nominal output length
+delay = floor((length(h)-1)/2/q);
+outLen = ceil(size(x,1)*p/q);
+y = y(delay+1:min(delay+outLen,size(y,1)),:);
+end
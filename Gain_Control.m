@@ -0,0 +1,88 @@
+classdef Gain_Control < handle
+    % Gain_Control Host-side RX gain control for the AD9361 in manual gain mode
+    %   The gain for the next capture is computed from the power of the
+    %   current capture, which scales 1 dB per dB of gain, so a single capture
+    %   is enough to converge. When the capture is clipped its power is not
+    %   reliable and the input level is predicted from the RSSI instead, using
+    %   the RSSI-to-power offset learnt on the last unclipped capture.
+    %   The RX buffer returns the oldest queued block, so a changed gain is
+    %   written directly (iio_sys_obj_matlab.writeCfgChannel) and the queued
+    %   blocks are flushed : the next capture is taken with the new gain.
+
+    properties (Access = public)
+        %full_scale Sample full scale, 2^(bits-1) of the capture iio_data_format
+        full_scale = 2^11;
+
+        %target_dbfs Target mean capture power [dBFS], leaves headroom for the OFDM PAPR
+        target_dbfs = -18;
+
+        %clip_ratio Fraction of clipped samples above which a capture is considered clipped
+        clip_ratio = 1e-4;
+
+        %min_gain Minimum hardware gain [dB]
+        min_gain = -3;
+
+        %max_gain Maximum hardware gain [dB]
+        max_gain = 71;
+
+        %gain Gain applied to the next capture [dB]
+        gain = 30;
+    end
+
+    properties (SetAccess = private)
+        %power_dbfs Mean power of the last capture [dBFS]
+        power_dbfs = 0;
+
+        %clipped Last capture was clipped
+        clipped = 0;
+    end
+
+    properties (Access = private)
+        lo_freq = 0;            % Current LO frequency
+        gain_cache = [];        % Converged gain per LO frequency
+        rssi_offset = NaN;      % power_dbfs - (gain - rssi) of the last unclipped capture
+    end
+
+    methods
+        function obj = Gain_Control()
+            obj.gain_cache = containers.Map('KeyType', 'double', 'ValueType', 'double');
+        end
+
+        function gain = setLO(obj, freq)
+            % Select the LO frequency, returns the gain cached for it
+            if(obj.lo_freq ~= 0)
+                obj.gain_cache(obj.lo_freq) = obj.gain;
+            end
+            obj.lo_freq = freq;
+            if(isKey(obj.gain_cache, freq))
+                obj.gain = obj.gain_cache(freq);
+            end
+            gain = obj.gain;
+        end
+
+        function [gain, changed] = update(obj, i_in, q_in, rssi)
+            % Compute the gain for the next capture from the current one
+            i_in = double(i_in);
+            q_in = double(q_in);
+            obj.power_dbfs = 10*log10(mean(i_in.^2 + q_in.^2)/obj.full_scale^2 + eps);
+            clip_cnt = sum(abs(i_in) >= obj.full_scale-1) + sum(abs(q_in) >= obj.full_scale-1);
+            obj.clipped = (clip_cnt > obj.clip_ratio*2*length(i_in));
+
+            if(~obj.clipped)
+                err = obj.target_dbfs - obj.power_dbfs;
+                obj.rssi_offset = obj.power_dbfs - (obj.gain - rssi);
+            elseif(~isnan(obj.rssi_offset))
+                err = obj.target_dbfs - (obj.gain - rssi + obj.rssi_offset);
+            else
+                err = -10; % Clipped without an RSSI reference, back off
+            end
+            new_gain = min(max(round(obj.gain + err), obj.min_gain), obj.max_gain);
+            changed = (new_gain ~= obj.gain);
+            obj.gain = new_gain;
+            if(obj.lo_freq ~= 0)
+                obj.gain_cache(obj.lo_freq) = obj.gain;
+            end
+            gain = obj.gain;
+        end
+    end
+end
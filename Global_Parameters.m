@@ -27,4 +27,17 @@ rmc2.OCNGPDSCHEnable = 'On';
 rmc2.OCNGPDCCHEnable = 'On';
 rmc2.SerialCat = true;
 rmc2.SamplingRate = 15.36e6;
-rmc2.Nfft = 1024;
\ No newline at end of file
+rmc2.Nfft = 1024;
+%% Cells decoded by the receiver
+rxCells = rmc; % [rmc rmc2] decodes both cells of OFDM_TX.m from the same capture
+%% Receiver options
+rxOpts.LLRBits = 0; % 0 : floating point soft bits, 8/16 : simulate int8/int16 quantised LLRs (the decoder runs in double)
+rxOpts.ImagePanel = 1; % 1 : show the image carried raw in each frame (OFDM_TX.m payloads)
+rxOpts.QueueDepth = 4; % Kernel blocks queued by the RX buffer : captures still taken with the previous transmission
+%% Runtime scheduling (see Runtime_Scheduling)
+sched.IOCores = [];       % CPUs of the radio I/O process, e.g. [0 1]
+sched.FifoPriority = 0;   % SCHED_FIFO priority of the radio I/O threads (0 : normal scheduling)
+sched.FifoTids = [];      % Threads given SCHED_FIFO ([] : the MATLAB thread calling libiio_mex)
+sched.NumaNode = -1;      % NUMA node of the radio I/O process memory (-1 : default placement)
+sched.DecodeWorkers = 0;  % Parallel pool workers for per-cell decoding (0 : no pool)
+sched.DecodeCores = [];   % CPUs of the decode workers, e.g. [2 3]
\ No newline at end of file
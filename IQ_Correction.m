@@ -0,0 +1,94 @@
+classdef IQ_Correction < handle
+    % IQ_Correction Streaming DC offset and IQ imbalance correction
+    %   The DC offset and the second order I/Q statistics are tracked with
+    %   recursive (exponentially weighted) estimators across captures. Each
+    %   capture is converted from int16 and corrected in a single pass:
+    %       I' = I - dc_i
+    %       Q' = ((Q - dc_q)/gain - I'*sin(phase)) / cos(phase)
+
+    properties (Access = public)
+        %alpha Estimator update weight per capture (1 : use the current capture only)
+        alpha = 0.2;
+
+        %enable Apply the correction (the estimates are always updated)
+        enable = 1;
+
+        %full_scale Sample full scale, 2^(bits-1) of the capture iio_data_format
+        full_scale = 2^11;
+    end
+
+    properties (SetAccess = private)
+        %dc DC offset estimate, full scale = 1
+        dc = 0;
+
+        %gain Q/I amplitude ratio estimate
+        gain = 1;
+
+        %phase Phase imbalance estimate [rad]
+        phase = 0;
+
+        %captures Number of captures processed
+        captures = 0;
+    end
+
+    properties (Access = private)
+        p_ii = 0;   % E[I^2] after DC removal
+        p_qq = 0;   % E[Q^2] after DC removal
+        p_iq = 0;   % E[I*Q] after DC removal
+    end
+
+    methods
+        function y = step(obj, i_in, q_in)
+            % Convert a capture to complex double (full scale = 1) and correct it
+            i_in = double(i_in)/obj.full_scale;
+            q_in = double(q_in)/obj.full_scale;
+
+            % The first capture initializes the estimators
+            a = obj.alpha;
+            if(obj.captures == 0)
+                a = 1;
+            end
+            obj.captures = obj.captures + 1;
+
+            % Update the estimates
+            dc_i = (1-a)*real(obj.dc) + a*mean(i_in);
+            dc_q = (1-a)*imag(obj.dc) + a*mean(q_in);
+            obj.dc = complex(dc_i, dc_q);
+            obj.p_ii = (1-a)*obj.p_ii + a*mean((i_in-dc_i).^2);
+            obj.p_qq = (1-a)*obj.p_qq + a*mean((q_in-dc_q).^2);
+            obj.p_iq = (1-a)*obj.p_iq + a*mean((i_in-dc_i).*(q_in-dc_q));
+            if((obj.p_ii > 0) && (obj.p_qq > 0))
+                obj.gain = sqrt(obj.p_qq/obj.p_ii);
+                obj.phase = asin(max(min(obj.p_iq/sqrt(obj.p_ii*obj.p_qq),1),-1));
+            end
+
+            if(obj.enable == 0)
+                y = complex(i_in, q_in);
+                return;
+            end
+
+            % Apply the correction
+            i_c = i_in - dc_i;
+            y = complex(i_c, ((q_in - dc_q)/obj.gain - i_c*sin(obj.phase))/cos(obj.phase));
+        end
+
+        function t = telemetry(obj)
+            % Returns the current estimates
+            t = struct('dc', obj.dc, ...
+                'gain_db', 20*log10(obj.gain), ...
+                'phase_deg', obj.phase*180/pi, ...
+                'captures', obj.captures);
+        end
+
+        function reset(obj)
+            % Restart the estimation, e.g. after an LO or gain change
+            obj.dc = 0;
+            obj.gain = 1;
+            obj.phase = 0;
+            obj.captures = 0;
+            obj.p_ii = 0;
+            obj.p_qq = 0;
+            obj.p_iq = 0;
+        end
+    end
+end
@@ -0,0 +1,115 @@
+classdef LO_Hopping < handle
+    % LO_Hopping Fast LO retune engine and hop scheduler for the AD9361
+    %   The first visit of a frequency performs a full LO write with the
+    %   calibrations enabled and stores the resulting synthesizer state in an
+    %   ad9361-phy fastlock profile. Later visits recall the profile with the
+    %   calibrations in manual mode, so a hop costs a single attribute write.
+    %   Frequencies changed through this object must not also be changed
+    %   through the RX_LO_FREQ/TX_LO_FREQ inputs of stepImpl.
+
+    properties (Constant)
+        NUM_PROFILES = 8;                   % Fastlock profiles per LO
+        RX_FASTLOCK_REG = hex2dec('25A');   % Rx Fast Lock Setup register
+        TX_FASTLOCK_REG = hex2dec('29A');   % Tx Fast Lock Setup register
+    end
+
+    properties (Access = public)
+        %lo LOs retuned on each hop ('RX' and/or 'TX')
+        lo = {'RX', 'TX'};
+
+        %schedule Hop frequencies [Hz], visited in order by next()
+        schedule = [];
+
+        %freq Current LO frequency [Hz]
+        freq = 0;
+    end
+
+    properties (Access = private)
+        sys_obj = [];                       % iio_sys_obj_matlab owning the control device
+        hop_idx = 0;                        % Current position in the schedule
+        profile_freq = zeros(1, 8);         % Frequency held by each profile (0 : free)
+        profile_use = zeros(1, 8);          % Last use of each profile, for LRU replacement
+        use_cnt = 0;
+    end
+
+    methods
+        function obj = LO_Hopping(sys_obj)
+            % Construct the hopper on top of an initialized iio_sys_obj_matlab
+            obj.sys_obj = sys_obj;
+        end
+
+        function [freq, method] = next(obj)
+            % Hop to the next frequency of the schedule
+            obj.hop_idx = mod(obj.hop_idx, length(obj.schedule)) + 1;
+            freq = obj.schedule(obj.hop_idx);
+            method = obj.retune(freq);
+        end
+
+        function method = retune(obj, freq)
+            % Tune the selected LOs, from the profile cache when possible
+            obj.use_cnt = obj.use_cnt + 1;
+            slot = find(obj.profile_freq == freq, 1);
+            if(~isempty(slot))
+                method = 'recall';
+                for i = 1 : length(obj.lo)
+                    recallProfile(obj, obj.lo{i}, slot - 1);
+                end
+            else
+                method = 'full';
+                [~, slot] = min(obj.profile_use); % Free or least recently used profile
+                obj.sys_obj.writeCtrlAttribute('calib_mode', 'auto');
+                stored = 1;
+                for i = 1 : length(obj.lo)
+                    obj.sys_obj.writeCtrlAttribute(loAttribute(obj, obj.lo{i}, 'frequency'), num2str(freq));
+                    % Bytes written on success, negative error code otherwise
+                    ret = obj.sys_obj.writeCtrlAttribute(loAttribute(obj, obj.lo{i}, 'fastlock_store'), num2str(slot - 1));
+                    stored = stored && (double(ret) >= 0);
+                end
+                obj.sys_obj.writeCtrlAttribute('calib_mode', 'manual');
+                % Only cache the frequency if the driver supports fastlock profiles
+                if(stored)
+                    obj.profile_freq(slot) = freq;
+                else
+                    obj.profile_freq(slot) = 0;
+                end
+            end
+            obj.profile_use(slot) = obj.use_cnt;
+            obj.freq = freq;
+        end
+
+        function clearCache(obj)
+            % Forget all the stored profiles
+            obj.profile_freq(:) = 0;
+            obj.profile_use(:) = 0;
+        end
+    end
+
+    methods (Access = private)
+        function name = loAttribute(~, lo, attr)
+            % Returns the ad9361-phy channel attribute name of an LO
+            if(strcmp(lo, 'RX'))
+                name = ['out_altvoltage0_RX_LO_' attr];
+            else
+                name = ['out_altvoltage1_TX_LO_' attr];
+            end
+        end
+
+        function ret = recallProfile(obj, lo, profile)
+            % Recall a fastlock profile, falling back to a direct register write
+            ret = obj.sys_obj.writeCtrlAttribute(loAttribute(obj, lo, 'fastlock_recall'), num2str(profile));
+            if(double(ret) >= 0)
+                return;
+            end
+            if(strcmp(lo, 'RX'))
+                reg = obj.RX_FASTLOCK_REG;
+            else
+                reg = obj.TX_FASTLOCK_REG;
+            end
+            val = bitor(bitshift(profile, 5), 1); % Fast lock profile [7:5] | fast lock mode enable
+            ret = obj.sys_obj.writeCtrlRegister(reg, val);
+            if(ret < 0)
+                ret = obj.sys_obj.writeCtrlDebugAttribute('direct_reg_access', sprintf('0x%X 0x%X', reg, val));
+            end
+        end
+    end
+end
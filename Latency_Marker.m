@@ -0,0 +1,88 @@
+classdef Latency_Marker < handle
+    % Latency_Marker Zadoff-Chu markers for over-the-air latency and sample continuity checks
+    %   embed() adds a ZC sequence every spacing samples of a TX waveform.
+    %   The root of the sequence is chosen by the push number modulo the
+    %   number of roots, so detect() can tell which push a capture holds
+    %   and where the first marker of that push lies in the capture. The
+    %   markers of one push are exactly spacing samples apart in the cyclic
+    %   TX buffer; any other gap between two markers of a capture means that
+    %   samples were dropped between the DMA and the host (overrun).
+
+    properties (Access = public)
+        %level_db Marker power relative to the waveform [dB]
+        level_db = -6;
+
+        %min_peak_ratio Minimum correlation peak to mean power ratio of a marker
+        min_peak_ratio = 30;
+    end
+
+    properties (SetAccess = private)
+        %spacing Samples between two markers
+        spacing = 15360;
+
+        %roots ZC roots, one per push modulo length(roots)
+        roots = [25 29 34 139];
+
+        %len ZC sequence length
+        len = 839;
+    end
+
+    properties (Access = private)
+        seq = {};   % ZC sequence of each root
+    end
+
+    methods
+        function obj = Latency_Marker(spacing)
+            % spacing : samples between two markers, must divide the TX waveform length
+            if(nargin > 0)
+                obj.spacing = spacing;
+            end
+            for k = 1 : length(obj.roots)
+                obj.seq{k} = lteZadoffChuSeq(obj.roots(k), obj.len);
+            end
+        end
+
+        function txdata = embed(obj, txdata, push_id)
+            % Add the markers of push push_id to an int16 TX waveform
+            k = mod(push_id, length(obj.roots)) + 1;
+            x = double(txdata);
+            amp = sqrt(mean(abs(x).^2))*10^(obj.level_db/20);
+            for p = 0 : obj.spacing : length(x) - obj.len
+                x(p + (1:obj.len)) = x(p + (1:obj.len)) + amp*obj.seq{k};
+            end
+            txdata = complex(int16(real(x)), int16(imag(x))); % int16 saturates
+        end
+
+        function [push_mod, pos, gaps] = detect(obj, x)
+            % Root index (push_id modulo the number of roots) and position of the first marker,
+            % gaps : spacing of the consecutive markers minus the nominal spacing
+            push_mod = -1;
+            pos = NaN;
+            gaps = [];
+            x = double(x(:));
+            nfft = 2^nextpow2(length(x));
+            X = fft(x, nfft);
+            best = 0;
+            for k = 1 : length(obj.roots)
+                m = abs(ifft(X .* conj(fft(obj.seq{k}, nfft)))).^2;
+                m = m(1 : length(x) - obj.len + 1);
+                peaks = find(m > obj.min_peak_ratio*mean(m));
+                if(isempty(peaks) || max(m) <= best)
+                    continue;
+                end
+                best = max(m);
+                % Keep the maximum of each cluster of neighbouring samples
+                starts = [1; find(diff(peaks) > obj.len) + 1];
+                ends = [starts(2:end) - 1; length(peaks)];
+                p = zeros(length(starts), 1);
+                for c = 1 : length(starts)
+                    [~, i] = max(m(peaks(starts(c) : ends(c))));
+                    p(c) = peaks(starts(c) + i - 1) - 1;
+                end
+                push_mod = k - 1;
+                pos = p(1);
+                gaps = diff(p) - obj.spacing;
+            end
+        end
+    end
+end
\ No newline at end of file
@@ -0,0 +1,177 @@
+classdef Link_Adaptation < handle
+    % Link_Adaptation Closed-loop selection of the downlink RMC from the receiver feedback
+    %   The candidate RMCs share the bandwidth and cell configuration of the
+    %   base rmc and differ in modulation, code rate and transport block size
+    %   (R.2 QPSK, R.3 16QAM, R.7 64QAM). Each decoded frame gives an SNR
+    %   estimate from the PDSCH EVM and the CRC of its subframes :
+    %     - an outer loop offsets the SNR by +step_db on a CRC failure and by
+    %       -step_db*target_bler/(1-target_bler) on a success, so the long-term
+    %       BLER converges to target_bler whatever the EVM-to-SNR bias is;
+    %     - the level goes down as soon as the corrected SNR falls below its
+    %       threshold, and up only after up_frames consecutive frames above the
+    %       next threshold plus hysteresis_db.
+    %   The TX waveform of each (level, payload) pair is generated once with
+    %   OFDM_TX_Waveform and cached, so a level change takes effect at the next
+    %   TX buffer push. The RX buffer returns the oldest queued block, so the
+    %   holdoff captures following a level change may still hold the previous
+    %   transmission; their feedback is ignored.
+
+    properties (Access = public)
+        %snr_threshold Minimum SNR of each level [dB]
+        snr_threshold = [-Inf 9 18];
+
+        %hysteresis_db Extra SNR margin required to go up one level [dB]
+        hysteresis_db = 1;
+
+        %up_frames Consecutive frames above the next threshold before going up
+        up_frames = 3;
+
+        %target_bler Outer loop block error rate target
+        target_bler = 0.1;
+
+        %step_db Outer loop step on a CRC failure [dB]
+        step_db = 1;
+
+        %holdoff Captures following a level change that may hold the previous transmission
+        holdoff = 4;
+    end
+
+    properties (SetAccess = private)
+        %rmc Candidate RMC configurations (cell array), lowest to highest rate
+        rmc = [];
+
+        %level Current level, index in rmc
+        level = 1;
+
+        %snr_db Last SNR estimate [dB]
+        snr_db = NaN;
+
+        %offset_db Outer loop SNR offset [dB]
+        offset_db = 0;
+
+        %frames Frames of feedback received
+        frames = 0;
+
+        %delivered_bits Bits of the subframes decoded with a correct CRC
+        delivered_bits = 0;
+
+        %failed_blocks Subframes with a CRC failure
+        failed_blocks = 0;
+
+        %total_blocks Subframes decoded
+        total_blocks = 0;
+    end
+
+    properties (Access = private)
+        up_count = 0;           % Consecutive frames above the next threshold
+        pending = 0;            % Captures left before the last level change is on air
+        waveforms = [];         % Cached TX waveform per level and payload
+        t_start = [];           % Start of the goodput measurement
+    end
+
+    methods
+        function obj = Link_Adaptation(base, rcs)
+            % base : customised RMC (cell identity, sampling rate, OCNG...) of Global_Parameters
+            % rcs  : candidate reference channels, default {'R.2','R.3','R.7'}
+            if(nargin < 2)
+                rcs = {'R.2', 'R.3', 'R.7'};
+            end
+            for k = 1 : length(rcs)
+                r = lteRMCDL(rcs{k});
+                r.NCellID = base.NCellID;
+                r.NFrame = base.NFrame;
+                r.TotSubframes = base.TotSubframes;
+                r.CellRefP = base.CellRefP;
+                r.PDSCH.RVSeq = base.PDSCH.RVSeq;
+                r.OCNGPDSCHEnable = base.OCNGPDSCHEnable;
+                r.OCNGPDCCHEnable = base.OCNGPDCCHEnable;
+                r.SerialCat = base.SerialCat;
+                r.SamplingRate = base.SamplingRate;
+                r.Nfft = base.Nfft;
+                rmcs{k} = r; %#ok<AGROW>
+            end
+            obj.rmc = rmcs;
+            obj.level = length(rcs);
+            obj.waveforms = containers.Map('KeyType', 'char', 'ValueType', 'any');
+        end
+
+        function r = current(obj)
+            % RMC of the next transmission, also used to decode it
+            r = obj.rmc{obj.level};
+        end
+
+        function txdata = waveform(obj, index, payload)
+            % TX waveform of payload number index at the current level
+            key = sprintf('%d/%d', obj.level, index);
+            if(~isKey(obj.waveforms, key))
+                t = Trace_Recorder.begin();
+                obj.waveforms(key) = OFDM_TX_Waveform(obj.rmc{obj.level}, payload);
+                Trace_Recorder.finish('TX/waveform', t);
+            end
+            txdata = obj.waveforms(key);
+        end
+
+        function update(obj, res)
+            % Feedback of one decoded frame, res : OFDM_RX_Decode result of the adapted cell
+            if(isempty(obj.t_start))
+                obj.t_start = tic;
+            end
+            if(obj.pending > 0)
+                obj.pending = obj.pending - 1; % Possibly decoded with the wrong RMC
+                return;
+            end
+            crc = res.blkcrc(~isnan(res.blkcrc));
+            if(isempty(crc) || sum(res.evmSF(:, 2)) == 0)
+                return; % Nothing decoded, keep the current level
+            end
+            obj.frames = obj.frames + 1;
+            tbs = obj.rmc{obj.level}.PDSCH.TrBlkSizes(:);
+            obj.delivered_bits = obj.delivered_bits + sum(tbs .* sum(res.blkcrc == 0, 2)); % Every frame of the capture
+            obj.failed_blocks = obj.failed_blocks + sum(crc == 1);
+            obj.total_blocks = obj.total_blocks + length(crc);
+
+            % SNR estimate from the PDSCH EVM
+            evm = sqrt(sum(res.evmSF(:, 1))/sum(res.evmSF(:, 2)));
+            obj.snr_db = -20*log10(max(evm, 1e-3));
+
+            % Outer loop
+            fails = sum(crc == 1);
+            obj.offset_db = obj.offset_db + obj.step_db*(fails - (length(crc) - fails)*obj.target_bler/(1 - obj.target_bler))/length(crc);
+            snr = obj.snr_db - obj.offset_db;
+
+            % Inner loop with hysteresis
+            if(snr < obj.snr_threshold(obj.level) && obj.level > 1)
+                obj.level = obj.level - 1;
+                obj.up_count = 0;
+                obj.pending = obj.holdoff;
+                Trace_Recorder.count('mcs_down', 1);
+            elseif(obj.level < length(obj.rmc) && snr >= obj.snr_threshold(obj.level + 1) + obj.hysteresis_db)
+                obj.up_count = obj.up_count + 1;
+                if(obj.up_count >= obj.up_frames)
+                    obj.level = obj.level + 1;
+                    obj.up_count = 0;
+                    obj.pending = obj.holdoff;
+                    Trace_Recorder.count('mcs_up', 1);
+                end
+            else
+                obj.up_count = 0;
+            end
+        end
+
+        function g = goodput(obj)
+            % Delivered bits per second since the first feedback
+            if(isempty(obj.t_start))
+                g = 0;
+            else
+                g = obj.delivered_bits/toc(obj.t_start);
+            end
+        end
+
+        function report(obj)
+            % Print the adaptation counters
+            fprintf('Link adaptation : level %d (%s), SNR %.1f dB, offset %.1f dB, BLER %.3f, goodput %.2f Mbit/s\n', ...
+                obj.level, obj.rmc{obj.level}.PDSCH.Modulation{1}, obj.snr_db, obj.offset_db, ...
+                obj.failed_blocks/max(obj.total_blocks, 1), goodput(obj)/1e6);
+        end
+    end
+end
\ No newline at end of file
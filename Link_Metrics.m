@@ -0,0 +1,132 @@
+classdef Link_Metrics < handle
+    % Link_Metrics Rolling link quality metrics over the last decoded frames
+    %   Every decoded capture adds one entry to fixed-size circular windows
+    %   of window entries : the EVM error and reference power sums per RB and
+    %   per subframe, the mean SNR, the CRC counts, the CFO and the frame
+    %   timing. The window sums are kept up to date by adding the new entry
+    %   and subtracting the one it replaces, so the memory and the cost per
+    %   update do not depend on the run length. telemetry() returns the
+    %   windowed metrics for monitoring, link adaptation or regression logs.
+    %   The CFO is only recorded on the captures where it was estimated, and
+    %   the timing only when the captures are contiguous (capture_advance),
+    %   unwrapped with the advance; otherwise the timing is the random phase
+    %   of each capture.
+
+    properties (Access = public)
+        %capture_advance Samples between the starts of consecutive updates, NaN : not contiguous
+        capture_advance = NaN;
+
+        %samples_per_frame Frame length [samples], 15.36 MHz sampling
+        samples_per_frame = 153600;
+    end
+
+    properties (SetAccess = private)
+        %window Entries of the rolling windows
+        window = 0;
+
+        %updates Entries added since the start
+        updates = 0;
+    end
+
+    properties (Access = private)
+        pos = 0;            % Last written entry
+        evm_rb = [];        % [window x numRB x 2] error / reference power per RB
+        evm_sf = [];        % [window x 10 x 2] error / reference power per subframe
+        snr = [];           % [window x 1] mean SNR per frame [dB]
+        crc = [];           % [window x 2] failed / decoded subframes
+        cfo = [];           % [window x 1] frequency offset [Hz]
+        timing = [];        % [window x 1] unwrapped frame timing [samples]
+        last_offset = NaN;  % Frame timing of the previous update
+        last_timing = 0;    % Unwrapped timing of the previous update
+        sum_rb = [];        % Window sums
+        sum_sf = [];
+        sum_crc = [];
+    end
+
+    methods
+        function obj = Link_Metrics(window, numRB)
+            % window : entries of the rolling windows, numRB : resource blocks (50 for 10 MHz)
+            obj.window = window;
+            obj.evm_rb = zeros(window, numRB, 2);
+            obj.evm_sf = zeros(window, 10, 2);
+            obj.snr = NaN(window, 1);
+            obj.crc = zeros(window, 2);
+            obj.cfo = NaN(window, 1);
+            obj.timing = NaN(window, 1);
+            obj.sum_rb = zeros(1, numRB, 2);
+            obj.sum_sf = zeros(1, 10, 2);
+            obj.sum_crc = zeros(1, 2);
+        end
+
+        function update(obj, res)
+            % Add the OFDM_RX result of one cell
+            k = mod(obj.pos, obj.window) + 1;
+            new_rb = reshape(res.evmRB, 1, [], 2);
+            new_sf = reshape(res.evmSF, 1, 10, 2);
+            crc = res.blkcrc(~isnan(res.blkcrc));
+            new_crc = [sum(crc == 1) length(crc)];
+            obj.sum_rb = obj.sum_rb + new_rb - obj.evm_rb(k, :, :);
+            obj.sum_sf = obj.sum_sf + new_sf - obj.evm_sf(k, :, :);
+            obj.sum_crc = obj.sum_crc + new_crc - obj.crc(k, :);
+            obj.evm_rb(k, :, :) = new_rb;
+            obj.evm_sf(k, :, :) = new_sf;
+            obj.crc(k, :) = new_crc;
+            obj.snr(k) = 10*log10(mean(10.^(res.snrSF(~isnan(res.snrSF))/10)));
+            obj.cfo(k) = NaN;
+            if(res.cfoEstimated)
+                obj.cfo(k) = res.frequencyOffset;
+            end
+            obj.timing(k) = NaN;
+            if(~isnan(obj.capture_advance) && ~isnan(obj.last_offset))
+                % Timing error against the prediction frameOffset - capture_advance (as in
+                % RX_Tracker.findFrame), wrapped to half a frame
+                F = obj.samples_per_frame;
+                err = mod(res.frameOffset - obj.last_offset + obj.capture_advance + F/2, F) - F/2;
+                obj.last_timing = obj.last_timing + err;
+                obj.timing(k) = obj.last_timing;
+            end
+            obj.last_offset = res.frameOffset;
+            obj.pos = k;
+            obj.updates = obj.updates + 1;
+        end
+
+        function t = telemetry(obj)
+            % Returns the metrics over the current window
+            n = min(obj.updates, obj.window);
+            order = mod(obj.pos - n + (0:n-1), obj.window) + 1; % Oldest to newest
+            cfo = obj.cfo(order);
+            timing = obj.timing(order);
+            t = struct('frames', n, ...
+                'evm_pct', 100*sqrt(sum(obj.sum_sf(:, :, 1))/max(sum(obj.sum_sf(:, :, 2)), eps)), ...
+                'evm_rb_pct', 100*sqrt(obj.sum_rb(:, :, 1)./max(obj.sum_rb(:, :, 2), eps)), ...
+                'evm_sf_pct', 100*sqrt(obj.sum_sf(:, :, 1)./max(obj.sum_sf(:, :, 2), eps)), ...
+                'snr_db', mean(obj.snr(order), 'omitnan'), ...
+                'bler', obj.sum_crc(1)/max(obj.sum_crc(2), 1), ...
+                'cfo_hz', mean(cfo, 'omitnan'), ...
+                'cfo_drift_hz', Link_Metrics.drift(cfo), ...
+                'timing_drift', Link_Metrics.drift(timing));
+        end
+
+        function report(obj)
+            % Print the windowed metrics
+            t = telemetry(obj);
+            fprintf('Link metrics (%d frames) : EVM %.2f %%, SNR %.1f dB, BLER %.3f, CFO %.0f Hz (drift %.1f Hz/frame), timing drift %.1f samples/frame\n', ...
+                t.frames, t.evm_pct, t.snr_db, t.bler, t.cfo_hz, t.cfo_drift_hz, t.timing_drift);
+            [worst, rb] = max(t.evm_rb_pct);
+            fprintf('  worst RB %d : EVM %.2f %%\n', rb - 1, worst);
+        end
+    end
+
+    methods (Static, Access = private)
+        function d = drift(x)
+            % Least squares slope per entry, the NaN entries keep their position
+            n = find(~isnan(x(:)));
+            x = x(n);
+            if(length(x) < 2)
+                d = 0;
+                return;
+            end
+            d = sum((n - mean(n)).*(x(:) - mean(x)))/sum((n - mean(n)).^2);
+        end
+    end
+end
\ No newline at end of file
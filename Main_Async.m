@@ -0,0 +1,59 @@
+clear;close all;clc;
+Global_Parameters;
+%% Button setting
+figure('Name','TX','NumberTitle','off');
+button = uicontrol; % Generate GUI button
+set(button,'String','Stop !','Position',[1050 15 100 60]); % Add "Stop !" text
+set(button,'Callback','setstate0'); % Set the reaction of pushing button
+%% TRX Main
+state = 1; % status Start
+index = 1;
+TX_IP = '192.168.3.6';
+RX_IP = '192.168.3.7';
+%% Asynchronous board access : one worker per board, the client only decodes
+loop = iio_event_loop(2);
+res = loop.wait(loop.submit(TX_IP,{'open',zeros(153600,1),CenterFrequency,rmc}));
+loop.wait(loop.submit(RX_IP,{'open',0,CenterFrequency,rmc}));
+scan_elm_no = res{1}; % Scan elements of the TX DAC
+%% TX signal load
+wfl = [];
+if exist('Picture_all.wfl','file')
+    wfl = Waveform_Library('Picture_all.wfl'); % TX waveforms, interleaved in DAC scan order
+end
+if isempty(wfl) || wfl.scan_elm_no ~= scan_elm_no % Built for the scan elements of the opened DAC
+    load('Picture_all.mat');
+    Waveform_Library.build('Picture_all.wfl',{Picture_all.txdata},scan_elm_no);
+    wfl = Waveform_Library('Picture_all.wfl');
+end
+iq_corr = IQ_Correction; % Host-side DC offset and IQ imbalance correction
+rx_tracker = RX_Tracker; % Skips the cell search once the cells are acquired
+
+% The TX push and the next RX capture are in flight while the previous capture is decoded
+txId = loop.submit(TX_IP,{'step',wfl.get(index)});
+rxId = loop.submit(RX_IP,{'step'});
+while(state==1)
+    try
+        loop.wait(txId);
+        rx = loop.wait(rxId);
+        index = mod(index,wfl.count)+1;
+        txId = loop.submit(TX_IP,{'step',wfl.get(index)});
+        rxId = loop.submit(RX_IP,{'step'});
+
+        if isa(rx{1},'MException')
+            rethrow(rx{1});
+        end
+        output2 = rx{1};
+        rxWaveform = iq_corr.step(output2{1},output2{2}); % DC offset and IQ imbalance correction
+        OFDM_RX(rxWaveform,rxCells,output2{end-1},rxOpts,rx_tracker); % RX1_RSSI
+    catch
+        ErrorMessage = lasterr;
+        fprintf('Error Message : \n');
+        disp(ErrorMessage);
+        fprintf(2,'Error occurred & Stop Hardware\n');
+    end % try Loop
+end % While Loop
+
+loop.wait(loop.submit(TX_IP,{'close'}));
+loop.wait(loop.submit(RX_IP,{'close'}));
+close all;
+disp('Software Complete');
@@ -1,44 +1,159 @@
 clear;close all;clc;j=1i;
 Global_Parameters;
-%% TX signal load
-load('Picture_all.mat');
+%% TX configuration
+Payload_Mode = ''; % 'raw' | 'deflate' | 'jpeg' : full-size images segmented over many frames, '' : one downscaled image per frame
+Link_Adapt = 0; % 1 : Closed-loop RMC selection (QPSK/16QAM/64QAM) from the decoded frames
+if ~isempty(Payload_Mode) && Link_Adapt
+    error('Payload_Mode and Link_Adapt cannot be combined : the payload library and reassembler use the TBS of the base rmc');
+end
 %% Button setting
 figure('Name','TX','NumberTitle','off');
 button = uicontrol; % Generate GUI button
 set(button,'String','Stop !','Position',[1050 15 100 60]); % Add "Stop !" text
 %% TRX Main
 state = 1; % status Start
-Ready_Time = 3;
+Host_AGC = 1; % 1 : Host-side manual gain control, no warm-up captures are discarded
+Ready_Time = 3*(1-Host_AGC);
 Run_time_number = 1;
 index = 1;
+Realtime_TX = 0; % 1 : Generate the TX waveform from the payload every iteration
+if Realtime_TX || Link_Adapt
+    load('Picture_all.mat'); % Payloads
+end
+Trace_Period = 10; % Iterations between trace snapshots (trace_snapshot.txt/.json)
+tracer = Trace_Recorder.instance(); % Stage timers and counters
+Record_Dir = ''; % Directory receiving every capture as int16 interleaved I/Q (.iq) for Batch_Decode, '' : off
+Record_Packed = 0; % 1 : record 12-bit packed and deflated captures (.iqp) instead
+Capture_Trigger = ''; % IIO trigger of the capture device on capable hardware, '' : free running
 %% New Add
 txWaveform = zeros(153600,1);
 [s,input] = iio_Hardware_setting('192.168.3.6',txWaveform,CenterFrequency,rmc); % TX
 [s2,input2] = iio_Hardware_setting('192.168.3.7',0,CenterFrequency,rmc); % RX
 
+if ~isempty(Capture_Trigger)
+    s2.setCaptureTrigger(Capture_Trigger);
+end
+%% TX signal load
+% The library entries are interleaved in the scan element order of the opened DAC
+scan_elm_no = s.getTxScanElements();
+if isempty(Payload_Mode)
+    wfl_file = 'Picture_all.wfl';
+else
+    wfl_file = ['Payload_',Payload_Mode,'.wfl'];
+end
+wfl = [];
+if exist(wfl_file,'file')
+    wfl = Waveform_Library(wfl_file); % TX waveforms, interleaved in DAC scan order
+end
+if isempty(wfl) || wfl.scan_elm_no ~= scan_elm_no
+    load('Picture_all.mat');
+    if isempty(Payload_Mode)
+        Waveform_Library.build(wfl_file,{Picture_all.txdata},scan_elm_no); % One-time conversion to the memory-mapped library
+    else
+        Payload_Library(wfl_file,Picture_all,rmc,Payload_Mode,scan_elm_no);
+    end
+    wfl = Waveform_Library(wfl_file);
+end
+if ~isempty(Payload_Mode)
+    reasm = Payload_Reassembler(rmc); % Incremental reassembly of the received segments
+    rxOpts.ImagePanel = 0;
+end
+Runtime_Scheduling(sched); % CPU pinning, priority and decode pool
+sched_mon = Sched_Monitor; % Per-thread CPU time and wakeup latency
+iq_corr = IQ_Correction; % Host-side DC offset and IQ imbalance correction
+rx_tracker = RX_Tracker; % Skips the cell search once the cells are acquired
+gate = Burst_Gate(rxCells); % Skips the captures without a frame
+metrics = Link_Metrics(100,rmc.NDLRB); % EVM per RB/subframe, SNR, BLER, CFO and timing drift over 100 frames
+metrics.capture_advance = rx_tracker.capture_advance; % NaN : captures not contiguous, the timing drift is not measured
+if Link_Adapt
+    la = Link_Adaptation(rmc); % R.2/R.3/R.7 with the cell configuration of rmc
+    la.holdoff = rxOpts.QueueDepth; % Captures queued with the previous level
+end
+agc = Gain_Control; % Host-side RX gain control
+rxFormat = s2.getOutDataFormat(); % Capture sample format (12-bit samples in 16-bit words)
+agc.full_scale = 2^(rxFormat.bits-1);
+iq_corr.full_scale = agc.full_scale;
+if Host_AGC
+    % Written directly, the stepImpl inputs stay empty so the gain is not rewritten per capture
+    s2.writeCfgChannel('RX1_GAIN_MODE','manual');
+    s2.writeCfgChannel('RX1_GAIN',agc.setLO(CenterFrequency));
+    input2{s2.getInChannel('RX1_GAIN_MODE')} = [];
+    input2{s2.getInChannel('RX1_GAIN')} = [];
+    s2.flushCapture(); % Captures queued with the automatic gain are dropped
+end
+
 while(state==1)
     try
-        if index > 10
+        if index > wfl.count
             index = 1;
         end
-        txWaveform = Picture_all(index).txdata;
-        input{1} = real(txWaveform);
-        input{2} = imag(txWaveform);
+        if Link_Adapt
+            txWaveform = la.waveform(index,Picture_all(index).data); % Cached per level and payload
+            rxCells = la.current(); % Decoded with the RMC of this transmission
+            input{1} = real(txWaveform);
+            input{2} = imag(txWaveform);
+        elseif Realtime_TX
+            txWaveform = OFDM_TX_Waveform(rmc,Picture_all(index).data);
+            input{1} = real(txWaveform);
+            input{2} = imag(txWaveform);
+        else
+            input{1} = wfl.get(index); % Copied into the TX buffer as is
+            input{2} = [];
+        end
         output = cell(1, s.out_ch_no + length(s.iio_dev_cfg.mon_ch)); % TX
         output2 = cell(1, s2.out_ch_no + length(s2.iio_dev_cfg.mon_ch)); % RX
         output = stepImpl(s, input); % TX
         output2 = stepImpl(s2, input2); % RX
-        rssi = output{s2.getOutChannel('RX1_RSSI')};
+        if ~isempty(Record_Dir)
+            if Record_Packed
+                % Header : sample count, bits, shift, compressed ; then the packed stream
+                fid = fopen(fullfile(Record_Dir,sprintf('capture_%06d.iqp',Run_time_number)),'w');
+                fwrite(fid,[2*length(output2{1}) rxFormat.bits rxFormat.shift 1],'uint32');
+                fwrite(fid,Pack_Samples([output2{1} output2{2}].',rxFormat,1),'uint8');
+            else
+                fid = fopen(fullfile(Record_Dir,sprintf('capture_%06d.iq',Run_time_number)),'w');
+                fwrite(fid,[output2{1} output2{2}].','int16');
+            end
+            fclose(fid);
+        end
+        rssi = output2{s2.getOutChannel('RX1_RSSI')};
+        if Host_AGC
+            [gain,changed] = agc.update(output2{1},output2{2},rssi); % Gain for the next capture
+            if changed
+                s2.writeCfgChannel('RX1_GAIN',gain);
+                s2.flushCapture(); % The next capture is taken with the new gain
+                rx_tracker.lose(); % Captures not contiguous across the flush
+            end
+        end
         
-        if Run_time_number > Ready_Time
-            rxWaveform = double(output2{1}+j*output2{2})*(2^-15);
-            OFDM_RX(rxWaveform,rmc,rssi);
+        if Run_time_number > Ready_Time && gate.step(output2{1},output2{2})
+            rxWaveform = iq_corr.step(output2{1},output2{2}); % DC offset and IQ imbalance correction
+            rxRes = OFDM_RX(rxWaveform,rxCells,rssi,rxOpts,rx_tracker);
+            rxFound = ~isempty(rxRes) && ~isempty(rxRes{1}); % Cell of rmc decoded
+            if rxFound
+                metrics.update(rxRes{1});
+            end
+            if ~isempty(Payload_Mode) && rxFound
+                images = reasm.add(rxRes{1});
+                for k = 1:length(images)
+                    subplot(2,3,5),imshow(images{k});
+                    title(['Reassembled Image , ',Payload_Mode]);
+                    drawnow;
+                end
+            end
+            if Link_Adapt && rxFound
+                la.update(rxRes{1}); % Level of the next transmission
+            end
         end
 
         if Run_time_number <= Ready_Time  % Ready
             disp('Ready');
         end
         Run_time_number = Run_time_number + 1;
+        sched_mon.sample();
+        if mod(Run_time_number,Trace_Period) == 0
+            tracer.snapshot('trace_snapshot');
+        end
 
         % ----- Button Behavior -----%
         set(button,'Callback','setstate0'); % Set the reaction of pushing button
@@ -60,4 +175,15 @@ end % While Loop
 s.releaseImpl();
 s2.releaseImpl();
 close all;
+sched_mon.report();
+gate.report();
+metrics.report();
+if ~isempty(Payload_Mode)
+    reasm.report();
+end
+if Link_Adapt
+    la.report();
+end
+tracer.snapshot('trace_snapshot');
+tracer.chromeTrace('trace_chrome.json');
 disp('Software Complete');
\ No newline at end of file
@@ -0,0 +1,262 @@
+function res = OFDM_RX_Decode(rmc,rxGrid,rxOpts,hint)
+% Per-cell channel estimation and MIB/PDSCH/DL-SCH decoding of a synchronised resource grid
+%   rxOpts : receiver options, see Global_Parameters
+%   hint   : optional tracking hint from RX_Tracker (CellRefP, NFrame, CFI per subframe),
+%            the PBCH and PCFICH are not decoded when given; with NFrame = NaN the
+%            PBCH is still decoded for the frame number
+%   res    : decoded bit stream, received frame numbers, CRCs, constellation symbols,
+%            CellRefP/NFrame/CFI, EVM accumulators per RB and per subframe, SNR per
+%            subframe and the high-water marks of the per-frame buffers
+persistent hwm; % High-water marks across calls : symbols written per capture, bits written per frame
+if isempty(hwm)
+    hwm = struct('symbols',0,'bits',0);
+end
+if nargin < 3
+    rxOpts = struct();
+end
+if ~isfield(rxOpts,'LLRBits')
+    rxOpts.LLRBits = 0;
+end
+if nargin < 4 || isempty(hint)
+    hint = struct('CellRefP',0,'NFrame',0,'CFI',NaN(1,10));
+end
+%% Channel estimation configuration structure
+cec.PilotAverage = 'UserDefined';  % Type of pilot symbol averaging
+cec.FreqWindow = 9;                % Frequency window size in REs
+cec.TimeWindow = 9;                % Time window size in REs
+cec.InterpType = 'Cubic';          % 2D interpolation type
+cec.InterpWindow = 'Centered';     % Interpolation window type
+cec.InterpWinSize = 3;             % Interpolation window size
+%% Receiver processing
+enb = rmc; % Set default LTE parameters
+enb.NSubframe = 0;
+
+sfDims = lteResourceGridSize(enb);
+Lsf = sfDims(2); % OFDM symbols per subframe
+LFrame = 10*Lsf; % OFDM symbols per frame
+numFullFrames = size(rxGrid,2)/LFrame;
+
+rxDataFrame = zeros(sum(enb.PDSCH.TrBlkSizes(:)),numFullFrames);
+recFrames = zeros(numFullFrames,1);
+decoded = false(numFullFrames,1); % Frame number known (PBCH decoded or hinted)
+blkcrc = NaN(10,numFullFrames); % NaN : subframe not decoded
+% Per-frame buffers are allocated once at their upper bound (every RE of 9 subframes) and trimmed at the end
+maxSymbols = 9*sfDims(1)*Lsf*numFullFrames;
+rxSymbols = complex(zeros(maxSymbols,1)); txSymbols = complex(zeros(maxSymbols,1)); % Complex, the first write does not convert the buffer
+numSymbols = 0;
+frameBits = size(rxDataFrame,1);
+rxdata = zeros(frameBits,1);
+maxBits = 0; % Most bits reassembled in one frame
+cfi = NaN(1,10);
+nest = NaN;
+cellRefP = 0; % 0 : PBCH not decoded
+% Link metrics : [error power, reference power] sums per RB and per subframe, SNR per subframe
+numRB = sfDims(1)/12;
+evmRB = zeros(numRB,2);
+evmSF = zeros(10,2);
+snrSF = NaN(10,numFullFrames);
+
+%% For each frame decode the MIB, PDSCH and DL-SCH
+for frame = 0:(numFullFrames-1)
+    fprintf('\nCell %i : performing DL-SCH Decode for frame %i of %i in burst:\n',rmc.NCellID,frame+1,numFullFrames)
+
+    if hint.CellRefP && ~isnan(hint.NFrame)
+        % Tracking : CellRefP and the frame number are known, the PBCH is not decoded
+        enb.CellRefP = hint.CellRefP;
+        enb.NFrame = mod(hint.NFrame+frame,1024);
+    else
+        % Extract subframe #0 from each frame of the received resource grid and channel estimate.
+        enb.NSubframe = 0;
+        rxsf = rxGrid(:,frame*LFrame+(1:Lsf),:);
+
+        % Perform channel estimation of subframe #0 for the PBCH, CellRefP is not known yet.
+        t = Trace_Recorder.begin();
+        [hestsf,nest] = lteDLChannelEstimate(enb,cec,rxsf);
+        Trace_Recorder.finish('OFDM_RX/channel_estimate', t);
+
+        % PBCH demodulation. Extract resource elements (REs) corresponding to the PBCH from the received grid and channel estimate grid for demodulation.
+        t = Trace_Recorder.begin();
+        enb.CellRefP = 1;
+        pbchIndices = ltePBCHIndices(enb);
+        [pbchRx,pbchHest] = lteExtractResources(pbchIndices,rxsf,hestsf);
+        [~,~,nfmod4,mib,CellRefP] = ltePBCHDecode(enb,pbchRx,pbchHest,nest);
+
+        % If PBCH decoding successful CellRefP~=0 then update info
+        if ~CellRefP
+            fprintf('No PBCH detected for frame.\n');
+            continue;
+        end
+        enb.CellRefP = CellRefP; % From ltePBCHDecode
+
+        % Decode the MIB to get current frame number
+        enb = lteMIB(mib,enb);
+
+        % Incorporate the nfmod4 value output from the function ltePBCHDecode, as the NFrame value established from the MIB is the system frame number modulo 4.
+        enb.NFrame = enb.NFrame+nfmod4;
+        Trace_Recorder.finish('OFDM_RX/pbch_mib', t);
+        fprintf('Successful MIB Decode.\n')
+    end
+    fprintf('Frame number: %d.\n',enb.NFrame);
+
+    % The eNodeB transmission bandwidth may be greater than the captured bandwidth, so limit the bandwidth for processing
+    enb.NDLRB = min(rmc.NDLRB,enb.NDLRB);
+
+    % Store received frame number
+    recFrames(frame+1) = enb.NFrame;
+    decoded(frame+1) = true;
+    cellRefP = enb.CellRefP;
+
+    % Process subframes within frame (ignoring subframe 5)
+    decbits = cell(1,10);
+    for sf = 0:9
+        if sf~=5 % Ignore subframe 5
+            % Extract subframe
+            enb.NSubframe = sf;
+            rxsf = rxGrid(:,frame*LFrame+sf*Lsf+(1:Lsf),:);
+
+            % Perform channel estimation with the correct number of CellRefP
+            t = Trace_Recorder.begin();
+            [hestsf,nestsf] = lteDLChannelEstimate(enb,cec,rxsf);
+            Trace_Recorder.finish('OFDM_RX/channel_estimate', t);
+            if isnan(nest)
+                nest = nestsf; % Tracking : no subframe #0 PBCH estimate
+            end
+
+            if isnan(hint.CFI(sf+1))
+                % PCFICH demodulation. Extract REs corresponding to the PCFICH from the received grid and channel estimate for demodulation.
+                t = Trace_Recorder.begin();
+                pcfichIndices = ltePCFICHIndices(enb);
+                [pcfichRx,pcfichHest] = lteExtractResources(pcfichIndices,rxsf,hestsf);
+                cfiBits = ltePCFICHDecode(enb,pcfichRx,pcfichHest,nestsf);
+
+                % CFI decoding
+                enb.CFI = lteCFIDecode(cfiBits);
+                Trace_Recorder.finish('OFDM_RX/pcfich_cfi', t);
+            else
+                enb.CFI = hint.CFI(sf+1); % Tracking : CFI of the last verification
+            end
+            cfi(sf+1) = enb.CFI;
+
+            % Get PDSCH indices
+            t = Trace_Recorder.begin();
+            [pdschIndices,pdschIndicesInfo] = ltePDSCHIndices(enb, enb.PDSCH, enb.PDSCH.PRBSet);
+            [pdschRx, pdschHest] = lteExtractResources(pdschIndices, rxsf, hestsf);
+
+            % Perform deprecoding, layer demapping, demodulation and descrambling on the received data using the estimate of the channel
+            [rxEncodedBits, rxEncodedSymb] = ltePDSCHDecode(enb,enb.PDSCH,pdschRx,pdschHest,nestsf);
+            Trace_Recorder.finish('OFDM_RX/pdsch', t);
+
+            % Fixed-point soft bits : the LLRs are quantised to int8/int16 with a 4 sigma range (simulated)
+            if rxOpts.LLRBits > 0
+                rxEncodedBits = Quantize_LLR(rxEncodedBits,rxOpts.LLRBits);
+            end
+
+            % Append decoded symbol to stream
+            rxSymb = vertcat(rxEncodedSymb{:});
+            rxSymbols(numSymbols+(1:length(rxSymb))) = rxSymb;
+
+            % Transport block sizes
+            outLen = enb.PDSCH.TrBlkSizes(enb.NSubframe+1);
+
+            % Decode DownLink Shared Channel (DL-SCH)
+            t = Trace_Recorder.begin();
+            [decbits{sf+1}, blkcrc(sf+1,frame+1)] = lteDLSCHDecode(enb,enb.PDSCH,outLen,rxEncodedBits);
+            Trace_Recorder.finish('OFDM_RX/dlsch', t);
+            if blkcrc(sf+1,frame+1)
+                Trace_Recorder.count('crc_fail', 1);
+            else
+                Trace_Recorder.count('crc_pass', 1);
+            end
+
+            % Recode transmitted PDSCH symbols for EVM calculation Encode transmitted DLSCH
+            t = Trace_Recorder.begin();
+            txRecode = lteDLSCH(enb,enb.PDSCH,pdschIndicesInfo.G,decbits{sf+1});
+            %   Modulate transmitted PDSCH
+            txRemod = ltePDSCH(enb, enb.PDSCH, txRecode);
+            %   Decode transmitted PDSCH
+            [~,refSymbols] = ltePDSCHDecode(enb, enb.PDSCH, txRemod);
+            %   Add encoded symbol to stream
+            txSymb = vertcat(refSymbols{:});
+            txSymbols(numSymbols+(1:length(txSymb))) = txSymb;
+            numSymbols = numSymbols+length(rxSymb);
+
+            % Link metrics : EVM sums per RB of the PDSCH REs, SNR from the noise estimate
+            rb = floor(mod(double(pdschIndices(1:length(rxSymb),1))-1,sfDims(1))/12)+1;
+            errPow = abs(rxSymb-txSymb).^2;
+            refPow = abs(txSymb).^2;
+            evmRB = evmRB + [accumarray(rb,errPow,[numRB 1]) accumarray(rb,refPow,[numRB 1])];
+            evmSF(sf+1,:) = evmSF(sf+1,:) + [sum(errPow) sum(refPow)];
+            snrSF(sf+1,frame+1) = 10*log10(mean(abs(hestsf(:)).^2)/nestsf);
+            Trace_Recorder.finish('OFDM_RX/evm_recode', t);
+        end
+    end
+
+    % Reassemble decoded bits
+    fprintf('Retrieving decoded transport block data.\n');
+    numBits = 0;
+    for i = 1:length(decbits)
+        if i~=6 % Ignore subframe 5
+            blk = vertcat(decbits{i}{:});
+            rxdata(numBits+(1:length(blk))) = blk;
+            numBits = numBits+length(blk);
+        end
+    end
+    maxBits = max(maxBits,numBits);
+    % Store data from receive frame
+    rxDataFrame(:,frame+1) = rxdata;
+end % Frame Loop
+%% Result Qualification
+% Determine index of first transmitted frame (lowest received frame number)
+[~,frameIdx] = min(recFrames);
+
+decodedRxDataStream = zeros(length(rxDataFrame(:)),1);
+frameLen = size(rxDataFrame,1);
+% Recombine received data blocks (in correct order) into continuous stream
+for n=1:numFullFrames
+    currFrame = mod(frameIdx-1,numFullFrames)+1; % Get current frame index
+    decodedRxDataStream((n-1)*frameLen+1:n*frameLen) = rxDataFrame(:,currFrame);
+    frameIdx = frameIdx+1; % Increment frame index
+end
+
+res.NCellID = rmc.NCellID;
+res.recFrames = recFrames;
+res.CellRefP = cellRefP;
+% Frame number of the first frame of the capture, from the first decoded frame
+k = find(decoded,1);
+if isempty(k)
+    res.NFrame = 0;
+else
+    res.NFrame = mod(recFrames(k)-(k-1),1024);
+end
+res.CFI = cfi;
+res.blkcrc = blkcrc;
+res.nest = nest;
+res.evmRB = evmRB;
+res.evmSF = evmSF;
+res.snrSF = snrSF;
+res.rxSymbols = rxSymbols(1:numSymbols);
+res.txSymbols = txSymbols(1:numSymbols);
+hwm.symbols = max(hwm.symbols,numSymbols);
+hwm.bits = max(hwm.bits,maxBits);
+res.hwm = hwm;
+res.decodedRxDataStream = decodedRxDataStream;
+end
+
+
+function llr = Quantize_LLR(llr,nbits)
+% Quantise each codeword of soft bits to a signed nbits integer and scale it back
+% lteDLSCHDecode only takes double soft bits, so this simulates the int8/int16 LLR
+% precision for the decode success comparison; the decoder itself runs in floating point
+qmax = 2^(nbits-1)-1;
+for cw = 1:length(llr)
+    step = 4*std(llr{cw})/qmax;
+    if step > 0
+        if nbits <= 8
+            q = int8(max(min(round(llr{cw}/step),qmax),-qmax));
+        else
+            q = int16(max(min(round(llr{cw}/step),qmax),-qmax));
+        end
+        llr{cw} = double(q)*step;
+    end
+end
+end
\ No newline at end of file
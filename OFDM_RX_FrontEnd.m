@@ -0,0 +1,87 @@
+function fe = OFDM_RX_FrontEnd(rxWaveform,rmc,tracker)
+% Shared receiver front end for one capture and one or more cells
+%   rmc     : struct array, one RMC configuration per cell to decode
+%   tracker : optional RX_Tracker, once locked the cell search is skipped and only the
+%             frame timing of the known cells is searched
+%   fe      : CFO-corrected samples, per-cell timing and the OFDM demodulated grids
+%             (cells with the same frame timing share one grid), cfoEstimated is 0 when
+%             the CFO of the last verification was reused. Every field is ordered as rmc,
+%             found(c) is 0 when the cell search did not detect rmc(c).NCellID, the cell
+%             is then not demodulated and gridIdx(c) is 0
+numCells = numel(rmc);
+samplesPerFrame = 10e-3*rmc(1).SamplingRate; % 153600 samples, LTE frames period is 10 ms
+enb = rmc(1);
+fe.tracked = nargin > 2 && tracker.isTracking(rmc);
+
+% Perform frequency offset correction, the CP correlation does not depend on the cell identity
+t = Trace_Recorder.begin();
+if fe.tracked && ~tracker.verify_due
+    fe.frequencyOffset = tracker.frequencyOffset; % Tracking : CFO of the last verification
+    fe.cfoEstimated = false;
+else
+    fe.frequencyOffset = lteFrequencyOffset(enb,rxWaveform);
+    fe.cfoEstimated = true;
+end
+rxWaveform = lteFrequencyCorrect(enb,rxWaveform,fe.frequencyOffset);
+Trace_Recorder.finish('OFDM_RX/frequency_correct', t);
+fprintf('\nCorrected a frequency offset of %i Hz.\n',fe.frequencyOffset)
+
+if fe.tracked
+    % Tracking : subframe 0 PSS/SSS correlation of the known cells only
+    t = Trace_Recorder.begin();
+    [fe.frameOffset,fe.corr] = tracker.findFrame(rxWaveform,rmc);
+    Trace_Recorder.finish('OFDM_RX/track_timing', t);
+    if any(isnan(fe.frameOffset))
+        fprintf('Tracking lost, returning to acquisition.\n');
+        tracker.lose();
+        fe.tracked = false;
+    else
+        fe.NCellID = tracker.NCellID;
+        fe.found = true(numCells,1);
+    end
+end
+if ~fe.tracked
+    % Perform the blind cell search to obtain cell identity and timing offset Use 'PostFFT' SSS detection method to improve speed
+    cellSearch.SSSDetection = 'PostFFT'; cellSearch.MaxCellCount = numCells;
+    t = Trace_Recorder.begin();
+    detected = lteCellSearch(enb,rxWaveform,cellSearch);
+    Trace_Recorder.finish('OFDM_RX/cell_search', t);
+    fprintf('Detected cell identities: %s.\n', num2str(detected(:).'));
+    % Detected identities are in correlation order, match them to the configured cells
+    fe.NCellID = reshape([rmc.NCellID],[],1);
+    fe.found = ismember(fe.NCellID,detected);
+
+    fe.frameOffset = zeros(numCells,1);
+    fe.corr = cell(numCells,1);
+    for c = find(fe.found).'
+        t = Trace_Recorder.begin();
+        [fe.frameOffset(c),fe.corr{c}] = lteDLFrameOffset(rmc(c),rxWaveform);
+        Trace_Recorder.finish('OFDM_RX/frame_offset', t);
+    end
+end
+
+fe.gridIdx = zeros(numCells,1);
+fe.rxGrid = {};
+gridOffsets = [];
+for c = 1:numCells
+    enb = rmc(c);
+    if ~fe.found(c)
+        fprintf('Cell %i : not found, skipped.\n',enb.NCellID);
+        continue;
+    end
+    fprintf('Cell %i : corrected a timing offset of %i samples.\n',enb.NCellID,fe.frameOffset(c))
+
+    % OFDM demodulate once per distinct frame timing
+    k = find(gridOffsets == fe.frameOffset(c),1);
+    if isempty(k)
+        % Sync the captured samples to the start of an LTE frame, a single full frame is demodulated
+        enb.NSubframe = 0;
+        gridOffsets(end+1) = fe.frameOffset(c); %#ok<AGROW>
+        t = Trace_Recorder.begin();
+        fe.rxGrid{end+1} = lteOFDMDemodulate(enb,rxWaveform(fe.frameOffset(c)+(1:samplesPerFrame))); % [307200x1] -> [153600x1]
+        Trace_Recorder.finish('OFDM_RX/ofdm_demodulate', t);
+        k = numel(gridOffsets);
+    end
+    fe.gridIdx(c) = k;
+end
+end
@@ -0,0 +1,30 @@
+function [txdata,txGrid] = OFDM_TX_Waveform(rmc,payload)
+% Generate the int16 LTE downlink frame for one payload
+%   payload : uint8 image (scaled and serialised as in OFDM_TX.m) or a binary column vector
+%   txdata  : int16 complex baseband, ready for the iio_buffer_start TX buffer
+if isa(payload,'uint8')
+    trData = Image_To_Bits(payload);
+else
+    trData = payload(:);
+end
+%% Generate Baseband LTE Signal
+% DL-SCH coding, PDSCH mapping, PSS/SSS/PBCH/CRS/PCFICH insertion and OFDM modulation
+[txWaveform,txGrid] = lteRMCDLTool(rmc,trData);
+% Scale the signal for better power output.
+powerScaleFactor = 0.7;
+txWaveform = txWaveform.*(1/max(abs(txWaveform))*powerScaleFactor);
+% Cast the transmit signal to int16
+txdata = int16(txWaveform*2^15);
+end
+
+function trData = Image_To_Bits(fData)
+% Downscale the image and convert it to an 8 bit binary stream
+scale = 0.2;                      % Image scaling factor
+origSize = size(fData);            % Original input image size
+scaledSize = max(floor(scale.*origSize(1:2)),1); % Calculate new image size
+heightIx = min(round(((1:scaledSize(1))-0.5)./scale+0.5),origSize(1));
+widthIx = min(round(((1:scaledSize(2))-0.5)./scale+0.5),origSize(2));
+fData = fData(heightIx,widthIx,:); % Resize image
+binData = dec2bin(fData(:),8);     % Convert to 8 bit unsigned binary
+trData = reshape((binData-'0').',1,[]).'; % Create binary stream
+end
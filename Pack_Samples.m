@@ -0,0 +1,39 @@
+function packed = Pack_Samples(samples,fmt,compress)
+% Pack_Samples Pack int16 samples to their significant bits for transport or recording
+%   samples  : int16 samples, e.g. interleaved I/Q
+%   fmt      : iio_data_format of the channel (bits, shift), see libiio_if.getDataFormat
+%   compress : 1 to deflate the packed stream (lossless)
+%   packed   : uint8 stream, ceil(numel(samples)*bits/8) bytes before compression
+% 12-bit samples take the fast path : two samples in three bytes.
+if nargin < 3
+    compress = 0;
+end
+v = bitand(bitshift(typecast(int16(samples(:)),'uint16'),-fmt.shift),uint16(2^fmt.bits-1));
+if fmt.bits == 16
+    packed = typecast(v,'uint8');
+elseif fmt.bits == 12
+    % a = v(1:2:end), b = v(2:2:end) : [a7..a0] [b3..b0 a11..a8] [b11..b4]
+    if mod(numel(v),2)
+        v(end+1) = 0;
+    end
+    a = v(1:2:end);
+    b = v(2:2:end);
+    packed = reshape([uint8(bitand(a,255)) ...
+        uint8(bitor(bitshift(a,-8),bitshift(bitand(b,15),4))) ...
+        uint8(bitshift(b,-4))].',[],1);
+else
+    % Generic bit stream, least significant bit first
+    bits = reshape(logical(bitget(repmat(v,1,fmt.bits),repmat(1:fmt.bits,numel(v),1))).',[],1);
+    bits(end+1:8*ceil(numel(bits)/8)) = false;
+    packed = uint8(reshape(bits,8,[]).'*(2.^(0:7)).');
+end
+if compress
+    % Lossless zlib stream, fastest level
+    deflater = java.util.zip.Deflater(1);
+    out = java.io.ByteArrayOutputStream();
+    stream = java.util.zip.DeflaterOutputStream(out,deflater);
+    stream.write(typecast(packed,'int8'));
+    stream.close();
+    packed = typecast(out.toByteArray(),'uint8');
+end
+end
\ No newline at end of file
@@ -0,0 +1,27 @@
+function payload = Payload_Decode(bytes)
+% Payload_Decode Restore a payload serialised by Payload_Encode
+bytes = bytes(:);
+dims = double(typecast(bytes(2:13),'uint32')).';
+data = bytes(14:end);
+switch bytes(1)
+    case 0
+        payload = reshape(data(1:prod(dims)),dims);
+    case 1
+        in = java.io.ByteArrayInputStream(typecast(data,'int8'));
+        stream = java.util.zip.InflaterInputStream(in);
+        out = java.io.ByteArrayOutputStream();
+        com.mathworks.mlwidgets.io.InterruptibleStreamCopier.getInterruptibleStreamCopier.copyStream(stream,out);
+        stream.close();
+        data = typecast(out.toByteArray(),'uint8');
+        payload = reshape(data(1:prod(dims)),dims);
+    case 2
+        file = [tempname '.jpg'];
+        fid = fopen(file,'w');
+        fwrite(fid,data,'uint8');
+        fclose(fid);
+        payload = imread(file);
+        delete(file);
+    otherwise
+        error('Payload_Decode : unknown mode %d',bytes(1));
+end
+end
\ No newline at end of file
@@ -0,0 +1,36 @@
+function bytes = Payload_Encode(payload,mode,quality)
+% Payload_Encode Serialise and compress a payload for the segmented transport
+%   payload : uint8 image [rows x cols x planes] or uint8 vector
+%   mode    : 'raw', 'deflate' (lossless zlib) or 'jpeg' (lossy, images only)
+%   quality : JPEG quality, default 75
+%   bytes   : uint8 column, [mode, rows, cols, planes (uint32)] followed by the data
+if nargin < 3
+    quality = 75;
+end
+dims = ones(1,3);
+dims(1:ndims(payload)) = size(payload);
+switch mode
+    case 'raw'
+        code = 0;
+        data = payload(:);
+    case 'deflate'
+        code = 1;
+        deflater = java.util.zip.Deflater(1); % Fastest level
+        out = java.io.ByteArrayOutputStream();
+        stream = java.util.zip.DeflaterOutputStream(out,deflater);
+        stream.write(typecast(payload(:),'int8'));
+        stream.close();
+        data = typecast(out.toByteArray(),'uint8');
+    case 'jpeg'
+        code = 2;
+        file = [tempname '.jpg'];
+        imwrite(payload,file,'Quality',quality);
+        fid = fopen(file,'r');
+        data = fread(fid,inf,'uint8=>uint8');
+        fclose(fid);
+        delete(file);
+    otherwise
+        error('Payload_Encode : unknown mode %s',mode);
+end
+bytes = [uint8(code); typecast(uint32(dims),'uint8').'; data(:)];
+end
\ No newline at end of file
@@ -0,0 +1,20 @@
+function Payload_Library(file,images,rmc,mode,scan_elm_no)
+% Payload_Library Build a waveform library carrying images with the segmented payload transport
+%   images : struct array with a data field (uint8 images), e.g. Picture_all
+%   mode   : compression of Payload_Encode, 'raw', 'deflate' or 'jpeg'
+%   scan_elm_no : scan elements of the TX device, see Waveform_Library.build
+% Each image keeps its full resolution and spans as many consecutive frames as it needs,
+% the payload id is the image index.
+if nargin < 5
+    scan_elm_no = 4;
+end
+waveforms = {};
+for k = 1:length(images)
+    frameBits = Payload_Segment(Payload_Encode(images(k).data,mode),k,rmc);
+    for f = 1:size(frameBits,2)
+        waveforms{end+1} = OFDM_TX_Waveform(rmc,frameBits(:,f)); %#ok<AGROW>
+    end
+    fprintf('Payload_Library : image %d, %d frames\n',k,size(frameBits,2));
+end
+Waveform_Library.build(file,waveforms,scan_elm_no);
+end
\ No newline at end of file
@@ -0,0 +1,120 @@
+classdef Payload_Reassembler < handle
+    % Payload_Reassembler Incremental reassembly of the segmented payloads
+    %   Every transport block decoded with a correct CRC holds one segment
+    %   (see Payload_Segment). The segments are stored per payload id as
+    %   they arrive, in any order and across any number of captures; a
+    %   payload is decoded with Payload_Decode as soon as all its segments
+    %   are in, so a segment lost in one pass of the cyclic transmission is
+    %   simply taken from the next pass.
+
+    properties (SetAccess = private)
+        %completed Payloads reassembled
+        completed = 0;
+
+        %delivered_bytes Payload bytes of the reassembled payloads
+        delivered_bytes = 0;
+
+        %delivered_pixels Pixels of the reassembled images
+        delivered_pixels = 0;
+
+        %segments Valid segments received
+        segments = 0;
+    end
+
+    properties (Access = private)
+        pending = [];       % containers.Map id -> struct(total, data, have)
+        tbs = [];           % Transport block sizes of one frame [bits]
+        sf = [];            % Subframe of each transport block
+        t_start = [];       % Start of the rate measurement
+    end
+
+    methods
+        function obj = Payload_Reassembler(rmc)
+            % rmc : RMC of the transmission, gives the transport block sizes
+            obj.pending = containers.Map('KeyType', 'double', 'ValueType', 'any');
+            tbs = rmc.PDSCH.TrBlkSizes(:);
+            obj.sf = find(tbs > 0);
+            obj.tbs = tbs(obj.sf);
+        end
+
+        function payloads = add(obj, res)
+            % Add the transport blocks of a decoded capture, returns the payloads completed by it
+            payloads = {};
+            if(isempty(obj.t_start))
+                obj.t_start = tic;
+            end
+            numFrames = size(res.blkcrc, 2);
+            frameBits = sum(obj.tbs);
+            [~, first] = min(res.recFrames);
+            for n = 1 : numFrames
+                f = mod(first - 1 + n - 1, numFrames) + 1; % Order of decodedRxDataStream
+                for k = 1 : length(obj.tbs)
+                    if(res.blkcrc(obj.sf(k), f) ~= 0)
+                        continue; % CRC failure or not decoded
+                    end
+                    offset = (n - 1)*frameBits + sum(obj.tbs(1:k-1));
+                    bits = res.decodedRxDataStream(offset + (1:8*floor(obj.tbs(k)/8)));
+                    blk = uint8(reshape(bits, 8, []).'*(2.^(7:-1:0)).');
+                    if(blk(1) ~= 165)
+                        continue; % Padding block
+                    end
+                    hdr = double(typecast(blk(3:10), 'uint16'));
+                    done = addSegment(obj, hdr(1), hdr(2), hdr(3), blk(10 + (1:hdr(4))));
+                    if(~isempty(done))
+                        payloads{end+1} = done; %#ok<AGROW>
+                    end
+                end
+            end
+        end
+
+        function r = rates(obj)
+            % Delivered bytes and pixels per second since the first capture
+            elapsed = max(toc(obj.t_start), eps);
+            r = struct('bytes_per_s', obj.delivered_bytes/elapsed, ...
+                'pixels_per_s', obj.delivered_pixels/elapsed, ...
+                'payloads_per_s', obj.completed/elapsed);
+        end
+
+        function report(obj)
+            % Print the delivery counters
+            if(isempty(obj.t_start))
+                return;
+            end
+            r = rates(obj);
+            fprintf('Payloads : %d reassembled from %d segments, %.1f kB/s, %.0f pixels/s, %d pending\n', ...
+                obj.completed, obj.segments, r.bytes_per_s/1e3, r.pixels_per_s, obj.pending.Count);
+        end
+    end
+
+    methods (Access = private)
+        function payload = addSegment(obj, id, seq, total, data)
+            % Store one segment, returns the decoded payload when it is complete
+            payload = [];
+            obj.segments = obj.segments + 1;
+            if(~isKey(obj.pending, id) || obj.pending(id).total ~= total)
+                obj.pending(id) = struct('total', total, 'data', {cell(1, total)}, 'have', false(1, total));
+            end
+            p = obj.pending(id);
+            p.data{seq + 1} = data(:);
+            p.have(seq + 1) = true;
+            if(~all(p.have))
+                obj.pending(id) = p;
+                return;
+            end
+            remove(obj.pending, id);
+            bytes = vertcat(p.data{:});
+            try
+                payload = Payload_Decode(bytes);
+            catch
+                Trace_Recorder.count('payload_decode_error', 1);
+                return;
+            end
+            obj.completed = obj.completed + 1;
+            obj.delivered_bytes = obj.delivered_bytes + length(bytes);
+            if(ndims(payload) == 3 || size(payload, 2) > 1)
+                obj.delivered_pixels = obj.delivered_pixels + size(payload, 1)*size(payload, 2);
+            end
+            Trace_Recorder.count('payloads', 1);
+        end
+    end
+end
\ No newline at end of file
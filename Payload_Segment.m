@@ -0,0 +1,37 @@
+function frameBits = Payload_Segment(bytes,id,rmc)
+% Payload_Segment Split a payload into transport blocks over consecutive LTE frames
+%   bytes     : payload from Payload_Encode
+%   id        : payload identifier (0..65535), distinguishes the payloads at the receiver
+%   frameBits : [frame bits x frames] binary data, one column per frame for OFDM_TX_Waveform
+% Each transport block carries one segment, its own CRC validates it :
+%   header (10 bytes) : 0xA5, 0, id (uint16), seq (uint16), total (uint16), length (uint16)
+%   then length payload bytes, zero padded to the transport block size
+headerBytes = 10;
+tbs = rmc.PDSCH.TrBlkSizes(:);
+tbs = tbs(tbs > 0); % Transport blocks of one frame (subframe 5 carries none)
+capacity = floor(tbs/8) - headerBytes;
+
+% Segment boundaries, the transport blocks of a frame repeat in every frame
+numBytes = length(bytes);
+segLen = [];
+while sum(segLen) < numBytes
+    segLen(end+1) = min(capacity(mod(length(segLen),length(tbs))+1),numBytes-sum(segLen)); %#ok<AGROW>
+end
+total = length(segLen);
+numFrames = ceil(total/length(tbs));
+frameBits = zeros(sum(tbs),numFrames);
+pos = 0;
+for seg = 1:numFrames*length(tbs)
+    k = mod(seg-1,length(tbs))+1;
+    f = ceil(seg/length(tbs));
+    blk = zeros(floor(tbs(k)/8),1,'uint8');
+    if seg <= total
+        blk(1:headerBytes) = [uint8([165 0]) typecast(uint16([id seg-1 total segLen(seg)]),'uint8')];
+        blk(headerBytes+(1:segLen(seg))) = bytes(pos+(1:segLen(seg)));
+        pos = pos + segLen(seg);
+    end
+    bits = reshape(bitget(repmat(blk,1,8),repmat(8:-1:1,length(blk),1)).',[],1); % MSB first
+    offset = sum(tbs(1:k-1));
+    frameBits(offset+(1:length(bits)),f) = bits;
+end
+end
\ No newline at end of file
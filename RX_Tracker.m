@@ -0,0 +1,191 @@
+classdef RX_Tracker < handle
+    % RX_Tracker Acquisition / tracking state of the receiver across captures
+    %   Acquisition runs the full front end : CFO estimation, blind cell
+    %   search, lteDLFrameOffset, then PBCH/MIB and PCFICH/CFI decoding.
+    %   Once the PBCH of every cell is decoded the tracker is locked and the
+    %   following captures only search the frame timing of the known cells
+    %   with their subframe 0 PSS/SSS, reuse the CFO estimate and take
+    %   CellRefP and the CFI from the last verification. The frame number is
+    %   predicted when capture_advance is known, otherwise the PBCH is still
+    %   decoded for it.
+    %   A full verification (CFO, PBCH, PCFICH) is run every verify_period
+    %   captures and after any CRC failure; the lock is lost when the
+    %   PSS/SSS peak of a cell is not found or its PBCH cannot be decoded.
+
+    properties (Access = public)
+        %enable 0 : always run the full acquisition
+        enable = 1;
+
+        %verify_period Captures between two full verifications
+        verify_period = 8;
+
+        %capture_advance Samples between the starts of consecutive captures, NaN : not contiguous
+        %   With a known advance only search_window samples around the predicted timing are searched.
+        capture_advance = NaN;
+
+        %search_window Half width of the timing search window around the prediction [samples]
+        search_window = 64;
+
+        %min_peak_ratio Minimum PSS/SSS correlation peak to mean power ratio
+        min_peak_ratio = 10;
+    end
+
+    properties (SetAccess = private)
+        %locked 1 : tracking mode
+        locked = 0;
+
+        %verify_due The next capture runs the full verification
+        verify_due = 1;
+
+        %NCellID Tracked cell identities
+        NCellID = [];
+
+        %frequencyOffset CFO of the last verification [Hz]
+        frequencyOffset = 0;
+
+        %frameOffset Frame timing of the last capture [samples]
+        frameOffset = [];
+
+        %hints Per-cell decoding hints for OFDM_RX_Decode (CellRefP, NFrame, CFI)
+        hints = [];
+
+        %captures Captures since the last verification
+        captures = 0;
+
+        %acquisitions Number of full acquisitions
+        acquisitions = 0;
+    end
+
+    properties (Access = private)
+        templates = {};     % Subframe 0 PSS/SSS waveform segment of each cell
+        template_pos = [];  % Position of the segment in the frame [samples]
+    end
+
+    methods
+        function tracking = isTracking(obj, rmc)
+            % 1 when the capture can skip the cell search
+            tracking = obj.enable && obj.locked && isequal(sort(obj.NCellID(:)), sort([rmc.NCellID].'));
+        end
+
+        function [offset, corr] = findFrame(obj, rxWaveform, rmc)
+            % Frame timing of each tracked cell from its subframe 0 PSS/SSS, NaN when not found
+            samplesPerFrame = 10e-3*rmc(1).SamplingRate;
+            numCells = numel(rmc);
+            if(numel(obj.templates) ~= numCells)
+                makeTemplates(obj, rmc);
+            end
+            offset = NaN(numCells, 1);
+            corr = cell(numCells, 1);
+            for c = 1 : numCells
+                ref = obj.templates{c};
+                n = length(ref);
+                p = obj.template_pos(c);
+                corr{c} = zeros(length(rxWaveform), 1);
+                if(~isnan(obj.capture_advance) && length(obj.frameOffset) == numCells)
+                    % Narrow window around the predicted timing, the capture start moved
+                    % forward by capture_advance so the frame boundary moved back
+                    pred = mod(obj.frameOffset(c) - obj.capture_advance, samplesPerFrame);
+                    lags = mod(pred + (-obj.search_window : obj.search_window), samplesPerFrame);
+                    m = zeros(length(lags), 1);
+                    for k = 1 : length(lags)
+                        m(k) = abs(ref' * rxWaveform(lags(k) + p + (1:n)))^2;
+                    end
+                else
+                    % Whole frame, FFT correlation
+                    lags = 0 : samplesPerFrame - 1;
+                    seg = rxWaveform(p + 1 : p + samplesPerFrame + n - 1);
+                    nfft = 2^nextpow2(length(seg));
+                    m = ifft(fft(seg, nfft) .* conj(fft(ref, nfft)));
+                    m = abs(m(1:samplesPerFrame)).^2;
+                end
+                [peak, k] = max(m);
+                corr{c}(lags + 1) = sqrt(m);
+                if(peak > obj.min_peak_ratio * mean(m))
+                    offset(c) = lags(k);
+                end
+            end
+        end
+
+        function update(obj, fe, res, tracked)
+            % Update the state from the front end and decoding results of a capture
+            %   tracked : 1 when the capture was processed in tracking mode
+            numCells = numel(res);
+            if(~tracked)
+                obj.acquisitions = obj.acquisitions + 1;
+                obj.templates = {};
+            end
+            if(~tracked || obj.verify_due)
+                obj.frequencyOffset = fe.frequencyOffset;
+                obj.captures = 0;
+            end
+            obj.NCellID = fe.NCellID(:);
+            obj.frameOffset = fe.frameOffset(:);
+            obj.captures = obj.captures + 1;
+            crc_fail = 0;
+            locked = 1;
+            hints = struct('CellRefP', cell(1, numCells), 'NFrame', 0, 'CFI', NaN(1, 10));
+            for c = 1 : numCells
+                if(res{c}.CellRefP == 0)
+                    locked = 0; % PBCH not decoded
+                end
+                hints(c).CellRefP = res{c}.CellRefP;
+                hints(c).NFrame = res{c}.NFrame;
+                hints(c).CFI = res{c}.CFI;
+                crc_fail = crc_fail || any(res{c}.blkcrc(:) == 1);
+            end
+            obj.hints = hints;
+            obj.locked = locked;
+            obj.verify_due = ~locked || crc_fail || obj.captures >= obj.verify_period;
+        end
+
+        function lose(obj)
+            % Return to acquisition, e.g. when the timing of a cell is not found
+            obj.locked = 0;
+            obj.verify_due = 1;
+            Trace_Recorder.count('lock_lost', 1);
+        end
+
+        function hints = decodeHints(obj, fe, rmc)
+            % Hints for OFDM_RX_Decode, empty when the PBCH and PCFICH must be decoded
+            numCells = numel(rmc);
+            if(obj.verify_due || numel(obj.hints) ~= numCells)
+                hints = cell(1, numCells);
+                return;
+            end
+            hints = num2cell(obj.hints);
+            if(isnan(obj.capture_advance))
+                % The frames elapsed since the last capture are unknown, NaN : decode the PBCH
+                for c = 1 : numCells
+                    hints{c}.NFrame = NaN;
+                end
+            else
+                % Predict the frame number from the frames elapsed since the last capture
+                samplesPerFrame = 10e-3*rmc(1).SamplingRate;
+                for c = 1 : numCells
+                    elapsed = round((obj.capture_advance + fe.frameOffset(c) - obj.frameOffset(c))/samplesPerFrame);
+                    hints{c}.NFrame = mod(hints{c}.NFrame + elapsed, 1024);
+                end
+            end
+        end
+    end
+
+    methods (Access = private)
+        function makeTemplates(obj, rmc)
+            % Time domain PSS and SSS of subframe 0, trimmed to their OFDM symbols
+            obj.templates = cell(1, numel(rmc));
+            obj.template_pos = zeros(1, numel(rmc));
+            for c = 1 : numel(rmc)
+                enb = rmc(c);
+                enb.NSubframe = 0;
+                enb.CellRefP = 1;
+                grid = lteDLResourceGrid(enb);
+                grid(ltePSSIndices(enb)) = ltePSS(enb);
+                grid(lteSSSIndices(enb)) = lteSSS(enb);
+                wf = lteOFDMModulate(enb, grid);
+                nz = find(wf ~= 0);
+                obj.templates{c} = wf(nz(1) : nz(end));
+                obj.template_pos(c) = nz(1) - 1;
+            end
+        end
+    end
+end
\ No newline at end of file
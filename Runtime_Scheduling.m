@@ -0,0 +1,68 @@
+function pool = Runtime_Scheduling(sched)
+% Runtime_Scheduling Apply the CPU, priority and NUMA placement of the radio I/O and decode processes
+%   sched.IOCores       : CPUs of the MATLAB client process that calls iio_buffer_refill/push ([] : any)
+%   sched.FifoPriority  : SCHED_FIFO priority of the radio I/O threads (0 : normal scheduling)
+%   sched.FifoTids      : thread ids given SCHED_FIFO ([] : the MATLAB thread calling the libiio_mex
+%                         refill/push, read with libiio_mex('tid')). The other threads of the process
+%                         (JVM, GC, UI) keep the normal scheduling, at real-time priority a busy one
+%                         would starve the I/O thread
+%   sched.NumaNode      : NUMA node holding the client memory (-1 : default placement)
+%   sched.DecodeWorkers : parallel pool size for the per-cell decoders (0 : no pool)
+%   sched.DecodeCores   : CPUs of the pool workers, kept apart from the I/O cores ([] : any)
+%   pool                : the decode pool, [] if none
+% Linux only, uses taskset, chrt and migratepages. Real-time priority requires CAP_SYS_NICE.
+pool = [];
+if ~isunix || ismac
+    fprintf(2,'Runtime_Scheduling : only supported on Linux\n');
+    return;
+end
+pid = feature('getpid');
+
+% Client process : I/O thread placement and priority
+if ~isempty(sched.IOCores)
+    Run_Command(sprintf('taskset -a -p -c %s %d',Cpu_List(sched.IOCores),pid));
+    maxNumCompThreads(length(sched.IOCores));
+end
+if sched.FifoPriority > 0
+    tids = sched.FifoTids;
+    if isempty(tids) && exist('libiio_mex','file') == 3
+        tids = libiio_mex('tid');
+    end
+    if isempty(tids)
+        fprintf(2,'Runtime_Scheduling : SCHED_FIFO not applied, set sched.FifoTids or build libiio_mex\n');
+    end
+    for k = 1:length(tids)
+        Run_Command(sprintf('chrt -f -p %d %d',sched.FifoPriority,tids(k)));
+    end
+end
+if sched.NumaNode >= 0
+    Run_Command(sprintf('migratepages %d all %d',pid,sched.NumaNode));
+end
+
+% Decode worker pool, pinned away from the I/O cores
+if sched.DecodeWorkers > 0
+    pool = gcp('nocreate');
+    if isempty(pool) || pool.NumWorkers ~= sched.DecodeWorkers
+        delete(pool);
+        pool = parpool('local',sched.DecodeWorkers);
+    end
+    if ~isempty(sched.DecodeCores)
+        f = parfevalOnAll(pool,@() feature('getpid'),1);
+        workerPids = unique(fetchOutputs(f));
+        for k = 1:length(workerPids)
+            Run_Command(sprintf('taskset -a -p -c %s %d',Cpu_List(sched.DecodeCores),workerPids(k)));
+        end
+    end
+end
+end
+
+function str = Cpu_List(cores)
+str = strjoin(arrayfun(@num2str,cores,'UniformOutput',false),',');
+end
+
+function Run_Command(cmd)
+[status,msg] = system([cmd ' 2>&1']);
+if status ~= 0
+    fprintf(2,'Runtime_Scheduling : %s failed : %s',cmd,msg);
+end
+end
@@ -0,0 +1,158 @@
+classdef Sample_Bus < handle
+    % Sample_Bus Shared-memory ring of captures, one producer and many consumers
+    %   The capture daemon owns the board and publishes every capture into a
+    %   ring of slots in /dev/shm; decoder, PSD monitor or recorder processes
+    %   open the same bus as consumers and read the slots straight from the
+    %   mapping. Each consumer keeps its own read cursor, so every subscriber
+    %   sees every capture, and the producer never waits for a consumer : a
+    %   consumer that falls more than slot_count captures behind is moved to
+    %   the oldest slot still in the ring and the skipped captures are counted
+    %   as lost. Each slot carries a sequence number written before (odd,
+    %   writing) and after (capture number) its data, a consumer that reads a
+    %   slot while it is overwritten detects it and counts an overrun.
+    %   MATLAB has no futex or eventfd, consumers poll the write sequence.
+    %
+    %   Header (uint64 words, page aligned) :
+    %     1 magic, 2 slot_count, 3 slot_samples, 4 write_seq,
+    %     5..12 consumer cursors, then slot_count sequences and slot_count RSSI (double)
+    %   Slots : int16 [2*slot_samples x slot_count], interleaved I/Q
+
+    properties (Constant)
+        magic = uint64(hex2dec('53414D50'));    % 'SAMP'
+        page_size = 4096;
+        max_consumers = 8;
+    end
+
+    properties (Access = public)
+        %poll_interval Consumer polling period [s]
+        poll_interval = 1e-3;
+    end
+
+    properties (SetAccess = private)
+        %file Shared-memory file
+        file = '';
+
+        %slot_count Captures held by the ring
+        slot_count = 0;
+
+        %slot_samples Complex samples per capture
+        slot_samples = 0;
+
+        %consumer Consumer index (1..max_consumers), 0 : producer
+        consumer = 0;
+
+        %cursor Next capture number to read (consumer)
+        cursor = 0;
+
+        %lost Captures overwritten before the consumer read them
+        lost = 0;
+    end
+
+    properties (Access = private)
+        hdr = [];       % memmapfile of the header
+        slots = [];     % memmapfile of the slots
+    end
+
+    methods
+        function obj = Sample_Bus(name, consumer, slot_count, slot_samples)
+            % Producer : Sample_Bus(name, 0, slot_count, slot_samples) creates the bus
+            % Consumer : Sample_Bus(name, consumer) attaches to it, consumer in 1..max_consumers
+            obj.file = fullfile('/dev/shm', name);
+            obj.consumer = consumer;
+            if(consumer == 0)
+                hdr_words = ceil((12 + 2*slot_count)*8/Sample_Bus.page_size)*Sample_Bus.page_size/8;
+                fid = fopen(obj.file, 'w');
+                fwrite(fid, zeros(hdr_words, 1, 'uint64'), 'uint64');
+                fwrite(fid, zeros(2*slot_samples*slot_count, 1, 'int16'), 'int16');
+                fclose(fid);
+                obj.hdr = memmapfile(obj.file, 'Format', {'uint64', [hdr_words 1], 'w'}, 'Repeat', 1, 'Writable', true);
+                obj.hdr.Data.w(2) = slot_count;
+                obj.hdr.Data.w(3) = slot_samples;
+                obj.hdr.Data.w(1) = Sample_Bus.magic; % Last : the bus is ready
+            else
+                obj.hdr = memmapfile(obj.file, 'Format', {'uint64', [12 1], 'w'}, 'Repeat', 1, 'Writable', true);
+                if(obj.hdr.Data.w(1) ~= Sample_Bus.magic)
+                    error('Sample_Bus : %s is not initialised', obj.file);
+                end
+                slot_count = double(obj.hdr.Data.w(2));
+                slot_samples = double(obj.hdr.Data.w(3));
+                hdr_words = ceil((12 + 2*slot_count)*8/Sample_Bus.page_size)*Sample_Bus.page_size/8;
+                obj.hdr = memmapfile(obj.file, 'Format', {'uint64', [hdr_words 1], 'w'}, 'Repeat', 1, 'Writable', true);
+                obj.cursor = double(obj.hdr.Data.w(4)); % Start with the next capture
+            end
+            obj.slot_count = slot_count;
+            obj.slot_samples = slot_samples;
+            obj.slots = memmapfile(obj.file, 'Offset', hdr_words*8, 'Format', ...
+                {'int16', [2*slot_samples slot_count], 'x'}, 'Repeat', 1, 'Writable', consumer == 0);
+        end
+
+        function publish(obj, i_in, q_in, rssi)
+            % Producer : write a capture into the next slot, never blocks
+            t = Trace_Recorder.begin();
+            seq = obj.hdr.Data.w(4);
+            k = mod(double(seq), obj.slot_count) + 1;
+            obj.hdr.Data.w(12 + k) = 2*seq + 1;                  % Odd : slot being written
+            obj.slots.Data.x(:, k) = reshape([i_in(:) q_in(:)].', [], 1);
+            obj.hdr.Data.w(12 + obj.slot_count + k) = typecast(double(rssi), 'uint64');
+            obj.hdr.Data.w(12 + k) = 2*seq + 2;                  % Even : capture seq published
+            obj.hdr.Data.w(4) = seq + 1;
+            Trace_Recorder.finish('bus/publish', t);
+        end
+
+        function [ok, i_out, q_out, rssi] = next(obj, timeout)
+            % Consumer : read the next capture, ok = 0 when none arrived within timeout [s]
+            ok = 0; i_out = []; q_out = []; rssi = 0;
+            t_start = tic;
+            while(double(obj.hdr.Data.w(4)) <= obj.cursor)
+                if(toc(t_start) > timeout)
+                    return;
+                end
+                pause(obj.poll_interval);
+            end
+            t = Trace_Recorder.begin();
+            while(~ok)
+                write_seq = double(obj.hdr.Data.w(4));
+                if(write_seq - obj.cursor > obj.slot_count)
+                    % Lapped by the producer : skip to the oldest capture in the ring
+                    obj.lost = obj.lost + write_seq - obj.slot_count - obj.cursor;
+                    Trace_Recorder.count('bus_lost', write_seq - obj.slot_count - obj.cursor);
+                    obj.cursor = write_seq - obj.slot_count;
+                end
+                k = mod(obj.cursor, obj.slot_count) + 1;
+                expected = uint64(2*obj.cursor + 2);
+                if(obj.hdr.Data.w(12 + k) ~= expected)
+                    obj.cursor = obj.cursor + 1; % Overwritten before the read started
+                    obj.lost = obj.lost + 1;
+                    continue;
+                end
+                x = obj.slots.Data.x(:, k);
+                rssi = typecast(obj.hdr.Data.w(12 + obj.slot_count + k), 'double');
+                ok = obj.hdr.Data.w(12 + k) == expected; % Not overwritten during the read
+                obj.cursor = obj.cursor + 1;
+                if(~ok)
+                    obj.lost = obj.lost + 1;
+                    Trace_Recorder.count('bus_overrun', 1);
+                end
+            end
+            i_out = x(1:2:end);
+            q_out = x(2:2:end);
+            obj.hdr.Data.w(4 + obj.consumer) = obj.cursor; % Published for the producer report
+            Trace_Recorder.finish('bus/next', t);
+        end
+
+        function report(obj)
+            % Print the lag of every attached consumer
+            write_seq = double(obj.hdr.Data.w(4));
+            fprintf('Sample bus %s : %d captures published\n', obj.file, write_seq);
+            for c = 1 : Sample_Bus.max_consumers
+                cur = double(obj.hdr.Data.w(4 + c));
+                if(cur > 0)
+                    fprintf('  consumer %d : %d captures behind\n', c, write_seq - cur);
+                end
+            end
+            if(obj.consumer > 0)
+                fprintf('  this consumer lost %d captures\n', obj.lost);
+            end
+        end
+    end
+end
\ No newline at end of file
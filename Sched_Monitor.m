@@ -0,0 +1,121 @@
+classdef Sched_Monitor < handle
+    % Sched_Monitor Per-thread CPU time and wakeup latency of the MATLAB client process
+    %   sample() is called once per loop iteration. It reads the per-thread
+    %   CPU time from /proc/<pid>/task/<tid>/stat and the run queue delay from
+    %   /proc/<pid>/task/<tid>/schedstat, i.e. the time a runnable thread waited
+    %   before being scheduled. The delay of each thread over the iteration
+    %   is added to the log2 histogram of that thread, in microseconds, so the
+    %   latency of the I/O thread is not mixed with the JVM and UI threads.
+    %   Linux only.
+
+    properties (Constant)
+        NUM_BINS = 24;      % Histogram bins : [0,1) [1,2) [2,4) ... microseconds
+    end
+
+    properties (SetAccess = private)
+        %cpu_time CPU time per thread [s], one row per thread id in tids
+        cpu_time = [];
+
+        %tids Thread ids of the process
+        tids = [];
+
+        %wakeup_hist Run queue delay histogram of the iterations, one row per thread id in tids
+        wakeup_hist = [];
+
+        %samples Number of iterations sampled
+        samples = 0;
+    end
+
+    properties (Access = private)
+        pid = 0;
+        clk_tck = 100;      % Clock ticks per second of /proc/<pid>/stat
+        last_cpu = [];      % Last utime+stime [ticks] per thread
+        last_wait = [];     % Last run queue delay [ns] per thread
+    end
+
+    methods
+        function obj = Sched_Monitor()
+            obj.pid = feature('getpid');
+            obj.wakeup_hist = zeros(0, obj.NUM_BINS);
+            [status, tck] = system('getconf CLK_TCK');
+            if(status == 0)
+                obj.clk_tck = str2double(tck);
+            end
+        end
+
+        function sample(obj)
+            % Accumulate the CPU time and run queue delay since the last sample
+            if(~isunix || ismac)
+                return;
+            end
+            task_dir = sprintf('/proc/%d/task', obj.pid);
+            list = dir(task_dir);
+            list = list(~ismember({list.name}, {'.', '..'}));
+            for k = 1 : length(list)
+                tid = str2double(list(k).name);
+                [cpu, wait] = readTask(obj, fullfile(task_dir, list(k).name));
+                idx = find(obj.tids == tid, 1);
+                if(isempty(idx))
+                    obj.tids(end+1) = tid;
+                    obj.cpu_time(end+1) = 0;
+                    obj.last_cpu(end+1) = cpu;
+                    obj.last_wait(end+1) = wait;
+                    obj.wakeup_hist(end+1, :) = 0;
+                    continue;
+                end
+                obj.cpu_time(idx) = obj.cpu_time(idx) + (cpu - obj.last_cpu(idx))/obj.clk_tck;
+                wait_ns = wait - obj.last_wait(idx);
+                obj.last_cpu(idx) = cpu;
+                obj.last_wait(idx) = wait;
+                bin = min(floor(log2(max(wait_ns/1e3, 1))) + 2, obj.NUM_BINS);
+                if(wait_ns < 1e3)
+                    bin = 1;
+                end
+                obj.wakeup_hist(idx, bin) = obj.wakeup_hist(idx, bin) + 1;
+            end
+            obj.samples = obj.samples + 1;
+        end
+
+        function report(obj)
+            % Print the busiest threads and their wakeup latency histograms
+            [cpu, order] = sort(obj.cpu_time, 'descend');
+            fprintf('\nThread CPU time over %d iterations:\n', obj.samples);
+            for k = 1 : min(8, length(order))
+                fprintf('  tid %6d : %8.3f s\n', obj.tids(order(k)), cpu(k));
+            end
+            for k = 1 : min(4, length(order))
+                fprintf('Run queue delay per iteration, tid %d:\n', obj.tids(order(k)));
+                h = obj.wakeup_hist(order(k), :);
+                for bin = find(h)
+                    if(bin == 1)
+                        fprintf('  [0, 1) us : %d\n', h(bin));
+                    else
+                        fprintf('  [%d, %d) us : %d\n', 2^(bin-2), 2^(bin-1), h(bin));
+                    end
+                end
+            end
+        end
+    end
+
+    methods (Access = private)
+        function [cpu, wait] = readTask(~, task_path)
+            % utime+stime [ticks] and run queue delay [ns] of one thread
+            cpu = 0;
+            wait = 0;
+            stat = fileread(fullfile(task_path, 'stat'));
+            % Fields after the command name, which is enclosed in parentheses
+            fields = sscanf(stat(find(stat == ')', 1, 'last')+2:end), '%*c %f');
+            if(length(fields) >= 12)
+                cpu = fields(11) + fields(12); % utime and stime, fields 14 and 15 of stat
+            end
+            fid = fopen(fullfile(task_path, 'schedstat'));
+            if(fid >= 0)
+                val = fscanf(fid, '%f');
+                fclose(fid);
+                if(length(val) >= 2)
+                    wait = val(2);
+                end
+            end
+        end
+    end
+end
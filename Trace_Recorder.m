@@ -0,0 +1,200 @@
+classdef Trace_Recorder < handle
+    % Trace_Recorder Stage timers, latency histograms and counters of the TX/RX chain
+    %   t = Trace_Recorder.begin();             start a stage timer
+    %   Trace_Recorder.finish('stage', t);      record the stage duration
+    %   Trace_Recorder.count('counter', n);     add n to a counter
+    %   tracer = Trace_Recorder.instance();     the recorder of this process
+    %   tracer.snapshot(f);                     write f.txt and f.json
+    %   tracer.chromeTrace(f);                  write a chrome://tracing file
+    %   The durations go to log-linear (HDR style) histograms with 8 sub-buckets
+    %   per power of two microseconds, i.e. 12.5% resolution at a fixed memory
+    %   cost. The last MAX_EVENTS events are kept for the Chrome trace.
+    %   Each MATLAB process (client or pool worker) has its own recorder.
+
+    properties (Constant)
+        SUB_BUCKETS = 8;        % Linear sub-buckets per power of two
+        NUM_BUCKETS = 8*32;     % Up to 2^32 us
+        MAX_EVENTS = 65536;     % Event ring size for the Chrome trace
+    end
+
+    properties (Access = public)
+        %enabled Record timers and counters
+        enabled = 1;
+    end
+
+    properties (SetAccess = private)
+        %stages Stage names, one histogram row per stage
+        stages = {};
+
+        %hist Duration histograms [stages x NUM_BUCKETS]
+        hist = [];
+
+        %total Total duration per stage [s]
+        total = [];
+
+        %counters Counter values by name
+        counters = struct();
+    end
+
+    properties (Access = private)
+        t_origin = [];                  % Time origin of the trace
+        stage_idx = [];                 % containers.Map stage name -> row
+        ev_stage = [];                  % Event ring : stage row
+        ev_start = [];                  % Event ring : start time [s]
+        ev_dur = [];                    % Event ring : duration [s]
+        ev_cnt = 0;                     % Events recorded since the start
+    end
+
+    methods (Static)
+        function obj = instance()
+            % Returns the recorder of this MATLAB process
+            persistent recorder;
+            if(isempty(recorder) || ~isvalid(recorder))
+                recorder = Trace_Recorder();
+            end
+            obj = recorder;
+        end
+
+        function t = begin()
+            % Start a stage timer
+            obj = Trace_Recorder.instance();
+            t = toc(obj.t_origin);
+        end
+
+        function finish(stage, t)
+            % Record the duration of a stage started with begin()
+            obj = Trace_Recorder.instance();
+            if(obj.enabled)
+                obj.record(stage, t, toc(obj.t_origin) - t);
+            end
+        end
+
+        function count(name, n)
+            % Add n to a counter
+            obj = Trace_Recorder.instance();
+            if(obj.enabled)
+                if(isfield(obj.counters, name))
+                    obj.counters.(name) = obj.counters.(name) + n;
+                else
+                    obj.counters.(name) = n;
+                end
+            end
+        end
+    end
+
+    methods
+        function obj = Trace_Recorder()
+            obj.t_origin = tic;
+            obj.stage_idx = containers.Map();
+            obj.ev_stage = zeros(obj.MAX_EVENTS, 1);
+            obj.ev_start = zeros(obj.MAX_EVENTS, 1);
+            obj.ev_dur = zeros(obj.MAX_EVENTS, 1);
+        end
+
+        function record(obj, stage, t_start, dur)
+            % Add one stage duration to the histograms and the event ring
+            if(isKey(obj.stage_idx, stage))
+                k = obj.stage_idx(stage);
+            else
+                k = length(obj.stages) + 1;
+                obj.stages{k} = stage;
+                obj.stage_idx(stage) = k;
+                obj.hist(k, obj.NUM_BUCKETS) = 0;
+                obj.total(k) = 0;
+            end
+            b = obj.bucket(dur*1e6);
+            obj.hist(k, b) = obj.hist(k, b) + 1;
+            obj.total(k) = obj.total(k) + dur;
+            e = mod(obj.ev_cnt, obj.MAX_EVENTS) + 1;
+            obj.ev_stage(e) = k;
+            obj.ev_start(e) = t_start;
+            obj.ev_dur(e) = dur;
+            obj.ev_cnt = obj.ev_cnt + 1;
+        end
+
+        function s = summary(obj)
+            % Per-stage count, mean and percentiles [us], and the counters
+            s = struct('stage', {}, 'count', {}, 'mean_us', {}, 'p50_us', {}, 'p99_us', {}, 'max_us', {});
+            for k = 1 : length(obj.stages)
+                n = sum(obj.hist(k,:));
+                s(k).stage = obj.stages{k};
+                s(k).count = n;
+                s(k).mean_us = obj.total(k)/n*1e6;
+                s(k).p50_us = obj.percentile(k, 0.50);
+                s(k).p99_us = obj.percentile(k, 0.99);
+                s(k).max_us = obj.percentile(k, 1);
+            end
+        end
+
+        function snapshot(obj, fname)
+            % Write the summary to fname.txt and fname.json
+            s = obj.summary();
+            fp = fopen([fname '.txt'], 'w');
+            fprintf(fp, '%-32s %8s %12s %12s %12s %12s\n', 'stage', 'count', 'mean [us]', 'p50 [us]', 'p99 [us]', 'max [us]');
+            for k = 1 : length(s)
+                fprintf(fp, '%-32s %8d %12.1f %12.1f %12.1f %12.1f\n', s(k).stage, s(k).count, s(k).mean_us, s(k).p50_us, s(k).p99_us, s(k).max_us);
+            end
+            names = fieldnames(obj.counters);
+            for k = 1 : length(names)
+                fprintf(fp, '%-32s %8d\n', names{k}, obj.counters.(names{k}));
+            end
+            fclose(fp);
+            fp = fopen([fname '.json'], 'w');
+            fprintf(fp, '%s', jsonencode(struct('stages', s, 'counters', obj.counters)));
+            fclose(fp);
+        end
+
+        function chromeTrace(obj, fname)
+            % Write the event ring in the Chrome trace event format
+            n = min(obj.ev_cnt, obj.MAX_EVENTS);
+            pid = feature('getpid');
+            fp = fopen(fname, 'w');
+            fprintf(fp, '{"traceEvents":[');
+            for e = 1 : n
+                if(e > 1)
+                    fprintf(fp, ',');
+                end
+                fprintf(fp, '{"name":"%s","ph":"X","ts":%.1f,"dur":%.1f,"pid":%d,"tid":1}', ...
+                    obj.stages{obj.ev_stage(e)}, obj.ev_start(e)*1e6, obj.ev_dur(e)*1e6, pid);
+            end
+            fprintf(fp, ']}');
+            fclose(fp);
+        end
+
+        function reset(obj)
+            % Clear the histograms, counters and events
+            obj.stages = {};
+            obj.stage_idx = containers.Map();
+            obj.hist = [];
+            obj.total = [];
+            obj.counters = struct();
+            obj.ev_cnt = 0;
+        end
+    end
+
+    methods (Access = private)
+        function b = bucket(obj, us)
+            % Log-linear bucket of a duration in microseconds
+            if(us < obj.SUB_BUCKETS)
+                b = floor(us) + 1;
+                return;
+            end
+            e = floor(log2(us));
+            sub = floor((us/2^e - 1)*obj.SUB_BUCKETS);
+            b = min((e - 2)*obj.SUB_BUCKETS + sub + 1, obj.NUM_BUCKETS);
+        end
+
+        function us = percentile(obj, k, p)
+            % Upper edge [us] of the bucket holding the p-th quantile of a stage
+            c = cumsum(obj.hist(k,:));
+            b = find(c >= p*c(end), 1);
+            if(b <= obj.SUB_BUCKETS)
+                us = b;
+            else
+                e = floor((b - 1)/obj.SUB_BUCKETS) + 2;
+                sub = mod(b - 1, obj.SUB_BUCKETS);
+                us = 2^e*(1 + (sub + 1)/obj.SUB_BUCKETS);
+            end
+        end
+    end
+end
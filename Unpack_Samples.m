@@ -0,0 +1,32 @@
+function samples = Unpack_Samples(packed,num,fmt,compressed)
+% Unpack_Samples Restore int16 samples packed by Pack_Samples
+%   num : number of samples, fmt : iio_data_format used for packing
+%   The samples are sign extended from fmt.bits, as iio_channel_convert does.
+if nargin < 4
+    compressed = 0;
+end
+if compressed
+    in = java.io.ByteArrayInputStream(typecast(packed(:),'int8'));
+    stream = java.util.zip.InflaterInputStream(in);
+    out = java.io.ByteArrayOutputStream();
+    com.mathworks.mlwidgets.io.InterruptibleStreamCopier.getInterruptibleStreamCopier.copyStream(stream,out);
+    stream.close();
+    packed = typecast(out.toByteArray(),'uint8');
+end
+packed = packed(:);
+if fmt.bits == 16
+    v = typecast(packed(1:2*num),'uint16');
+elseif fmt.bits == 12
+    p = reshape(packed(1:3*ceil(num/2)),3,[]).';
+    p = uint16(p);
+    v = reshape([bitor(p(:,1),bitshift(bitand(p(:,2),15),8)) ...
+        bitor(bitshift(p(:,2),-4),bitshift(p(:,3),4))].',[],1);
+    v = v(1:num);
+else
+    bits = reshape(logical(bitget(repmat(packed,1,8),repmat(1:8,numel(packed),1))).',[],1);
+    bits = reshape(bits(1:num*fmt.bits),fmt.bits,[]).';
+    v = uint16(double(bits)*(2.^(0:fmt.bits-1)).');
+end
+% Sign extension from fmt.bits
+samples = int16(double(v) - double(v >= 2^(fmt.bits-1))*2^fmt.bits);
+end
\ No newline at end of file
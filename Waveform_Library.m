@@ -0,0 +1,111 @@
+classdef Waveform_Library < handle
+    % Waveform_Library Indexed, memory-mapped store of TX waveforms
+    %   Each entry holds int16 I/Q already interleaved in the scan element
+    %   order of cf-ad9361-dds-core-lpc (I, Q, then zeros for the unused
+    %   elements), so an entry is copied into the TX buffer in one assignment.
+    %   The file is mapped with memmapfile : opening it only reads the index
+    %   and each entry is paged in when it is transmitted.
+    %
+    %   File layout (little endian, entries aligned to 4096-byte pages) :
+    %     header : 'WFLB', uint32 version, uint32 count, uint32 scan_elm_no
+    %     index  : count x [uint64 byte offset, uint32 samples, uint32 reserved]
+    %     data   : count x int16 [samples*scan_elm_no] interleaved entries
+
+    properties (Constant)
+        page_size = 4096;
+        version = 1;
+    end
+
+    properties (SetAccess = private)
+        %file Library file
+        file = '';
+
+        %count Number of waveforms
+        count = 0;
+
+        %scan_elm_no Scan elements per sample of the stored entries
+        scan_elm_no = 4;
+
+        %offset Byte offset of each entry
+        offset = [];
+
+        %samples Number of samples of each entry
+        samples = [];
+    end
+
+    properties (Access = private)
+        maps = {};              % memmapfile of each entry, created on first use
+    end
+
+    methods
+        function obj = Waveform_Library(file)
+            % Open the library and read its index
+            fid = fopen(file, 'r', 'l');
+            if(fid < 0)
+                error('Waveform_Library : cannot open %s', file);
+            end
+            magic = fread(fid, [1 4], 'char=>char');
+            hdr = fread(fid, 3, 'uint32');
+            if(~strcmp(magic, 'WFLB') || hdr(1) ~= Waveform_Library.version)
+                fclose(fid);
+                error('Waveform_Library : %s is not a waveform library', file);
+            end
+            obj.file = file;
+            obj.count = hdr(2);
+            obj.scan_elm_no = hdr(3);
+            idx = fread(fid, [4 obj.count], 'uint32');
+            fclose(fid);
+            obj.offset = idx(1,:) + idx(2,:)*2^32;
+            obj.samples = idx(3,:);
+            obj.maps = cell(1, obj.count);
+        end
+
+        function data = get(obj, k)
+            % Interleaved int16 entry k, ready for libiio_if.writeData
+            if(isempty(obj.maps{k}))
+                obj.maps{k} = memmapfile(obj.file, 'Offset', obj.offset(k), 'Format', ...
+                    {'int16', [obj.samples(k)*obj.scan_elm_no 1], 'x'}, 'Writable', false);
+            end
+            data = obj.maps{k}.Data.x;
+        end
+
+        function waveform = getComplex(obj, k)
+            % Complex double waveform of entry k
+            data = get(obj, k);
+            waveform = complex(double(data(1:obj.scan_elm_no:end)), double(data(2:obj.scan_elm_no:end)));
+        end
+    end
+
+    methods (Static)
+        function build(file, waveforms, scan_elm_no)
+            % Write a library from a cell array of complex waveforms
+            %   scan_elm_no : scan elements of the TX device, getTxScanElements() of the
+            %                 opened iio_sys_obj_matlab (4 for cf-ad9361-dds-core-lpc)
+            if(nargin < 3)
+                scan_elm_no = 4;
+            end
+            page = Waveform_Library.page_size;
+            count = length(waveforms);
+            samples = cellfun(@length, waveforms);
+            offset = zeros(1, count);
+            pos = ceil((16 + 16*count)/page)*page;
+            for k = 1 : count
+                offset(k) = pos;
+                pos = pos + ceil(2*scan_elm_no*samples(k)/page)*page;
+            end
+            fid = fopen(file, 'w', 'l');
+            fwrite(fid, 'WFLB', 'char');
+            fwrite(fid, [Waveform_Library.version count scan_elm_no], 'uint32');
+            fwrite(fid, [mod(offset, 2^32); floor(offset/2^32); samples; zeros(1, count)], 'uint32');
+            for k = 1 : count
+                data = zeros(scan_elm_no, samples(k), 'int16');
+                data(1,:) = int16(real(waveforms{k}));
+                data(2,:) = int16(imag(waveforms{k}));
+                fseek(fid, 0, 'eof');
+                fwrite(fid, zeros(1, offset(k) - ftell(fid), 'uint8'), 'uint8'); % Page alignment
+                fwrite(fid, data(:), 'int16');
+            end
+            fclose(fid);
+        end
+    end
+end
\ No newline at end of file
@@ -0,0 +1,56 @@
+function fir = ftr_read(fir_data_file)
+% ftr_read Parse an AD9361 filter wizard .ftr file
+%   fir.tx/fir.rx : coef (int16 taps), ch_mask, gain [dB], rate (INT/DEC factor)
+%                   and h, the taps normalised the way the hardware applies them
+%   fir.rtx/fir.rrx : clock chain rates [Hz], from BBPLL down to the data rate
+%   fir.bwtx/fir.bwrx : analog RF bandwidths [Hz]
+fir = struct('tx', [], 'rx', [], 'rtx', [], 'rrx', [], 'bwtx', 0, 'bwrx', 0);
+fir_data_str = fileread(fir_data_file);
+
+tx = regexp(fir_data_str, 'TX\s+(\d+)\s+GAIN\s+(-?\d+)\s+INT\s+(\d+)', 'tokens', 'once');
+rx = regexp(fir_data_str, 'RX\s+(\d+)\s+GAIN\s+(-?\d+)\s+DEC\s+(\d+)', 'tokens', 'once');
+rtx = regexp(fir_data_str, 'RTX\s+([\d ]+)', 'tokens', 'once');
+rrx = regexp(fir_data_str, 'RRX\s+([\d ]+)', 'tokens', 'once');
+bwtx = regexp(fir_data_str, 'BWTX\s+(\d+)', 'tokens', 'once');
+bwrx = regexp(fir_data_str, 'BWRX\s+(\d+)', 'tokens', 'once');
+
+% Coefficient lines hold the TX and RX taps, or a single column shared by both
+coef = regexp(fir_data_str, '^\s*(-?\d+)\s*(?:,\s*(-?\d+))?\s*$', 'tokens', 'lineanchors');
+coef_tx = zeros(length(coef), 1);
+coef_rx = zeros(length(coef), 1);
+for i = 1 : length(coef)
+    coef_tx(i) = str2double(coef{i}{1});
+    if(length(coef{i}) > 1 && ~isempty(coef{i}{2}))
+        coef_rx(i) = str2double(coef{i}{2});
+    else
+        coef_rx(i) = coef_tx(i);
+    end
+end
+
+fir.tx = ftrPath(tx, coef_tx);
+fir.rx = ftrPath(rx, coef_rx);
+if(~isempty(rtx))
+    fir.rtx = str2num(rtx{1}); %#ok<ST2NM>
+end
+if(~isempty(rrx))
+    fir.rrx = str2num(rrx{1}); %#ok<ST2NM>
+end
+if(~isempty(bwtx))
+    fir.bwtx = str2double(bwtx{1});
+end
+if(~isempty(bwrx))
+    fir.bwrx = str2double(bwrx{1});
+end
+end
+
+function p = ftrPath(tok, coef)
+% Build the description of one filter path
+p = struct('coef', int16(coef), 'ch_mask', 3, 'gain', 0, 'rate', 1, 'h', []);
+if(~isempty(tok))
+    p.ch_mask = str2double(tok{1});
+    p.gain = str2double(tok{2});
+    p.rate = str2double(tok{3});
+end
+% The hardware taps are Q15 values followed by the selected digital gain
+p.h = double(coef) / 2^15 * 10^(p.gain/20);
+end
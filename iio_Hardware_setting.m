@@ -1,11 +1,14 @@
-function [s,input] = iio_Hardware_setting(IP,txWaveform,CenterFrequency,rmc)
+function [s,input] = iio_Hardware_setting(IP,txWaveform,CenterFrequency,rmc,out_ch_size)
+    if nargin < 5
+        out_ch_size = 153600*2; % Two LTE frames per capture
+    end
     s = iio_sys_obj_matlab; % Hardware Parameter object
     s.ip_address = IP; % Direct Connect IP
     s.dev_name = 'ad9361';
     s.in_ch_no = 2;     % 2 for I and Q input Channel (1st Antenna)
     s.out_ch_no = 2;    % 2 for I and Q output Channel (1st Antenna)
     s.in_ch_size = length(txWaveform);
-    s.out_ch_size = 153600*2;
+    s.out_ch_size = out_ch_size;
     s = s.setupImpl();
     fir_data_file = 'LTE10_MHz.ftr';
     s.writeFirData(fir_data_file); % Configure the FIR filter
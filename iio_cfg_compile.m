@@ -0,0 +1,98 @@
+function config = iio_cfg_compile(dev_name)
+% iio_cfg_compile Compile a device configuration file into a typed table
+%   The <dev_name>.cfg text file is parsed once into <dev_name>_cfg.mat, which
+%   is reused until the .cfg file is modified. Each configuration/monitoring
+%   channel gets an integer port ID, and in_ch_idx/out_ch_idx map the port
+%   names to those IDs.
+fname = sprintf('%s.cfg', dev_name);
+cname = sprintf('%s_cfg.mat', dev_name);
+cfg_info = dir(fname);
+if(isempty(cfg_info))
+    config = {};
+    return;
+end
+
+% Reuse the compiled table if it is newer than the configuration file
+cmp_info = dir(cname);
+if(~isempty(cmp_info) && (cmp_info.datenum >= cfg_info.datenum))
+    tmp = load(cname);
+    config = tmp.config;
+    return;
+end
+
+% Open the configuration file
+fp_cfg = fopen(fname);
+if(fp_cfg < 0)
+    config = {};
+    return;
+end
+
+% Build the object configuration structure
+config = struct('data_in_device', '',...   % Pointer to the data input device
+    'data_out_device', '',...               % Pointer to the data output device
+    'ctrl_device', '',...                   % Pointer to the control device
+    'cfg_ch', [],...                        % Configuration channels list
+    'mon_ch', [],...                        % Monitoring channels list
+    'in_ch_names', [],...                   % Configuration channels names
+    'out_ch_names', [],...                  % Monitoring channels names
+    'in_ch_idx', struct(),...               % Configuration port IDs by name
+    'out_ch_idx', struct());                % Monitoring port IDs by name
+config.in_ch_names = {};
+config.out_ch_names = {};
+
+% Build the configuration/monitoring channels structure
+ch_cfg = struct('port_name', '',...         % Name of the port to be displayed on the object block
+    'port_id', 0,...                        % Index of the port in the configuration/monitoring list
+    'port_attr', '',...                     % Associated device attribute name
+    'ctrl_dev_name', '',...                 % Control device name
+    'ctrl_dev', 0,...                       % Pointer to the control device object
+    'attr_handle', []);                     % Attribute resolved on the control device
+
+% Read the object's configuration
+while(~feof(fp_cfg))
+    line = fgets(fp_cfg);
+    if(strfind(line,'#'))
+        continue;
+    end
+    if(~isempty(strfind(line, 'channel')))
+        % Get the associated configuration/monitoring channels
+        idx = strfind(line, '=');
+        line = line(idx+1:end);
+        line = strsplit(line, ',');
+        ch_cfg.port_name = strtrim(line{1});
+        ch_cfg.port_attr = strtrim(line{3});
+        if(length(line) > 4)
+            ch_cfg.ctrl_dev_name = strtrim(line{4});
+        else
+            ch_cfg.ctrl_dev_name = 'ctrl_device';
+        end
+        if(strcmp(strtrim(line{2}), 'IN'))
+            ch_cfg.port_id = length(config.cfg_ch) + 1;
+            config.cfg_ch = [config.cfg_ch ch_cfg];
+            config.in_ch_names = [config.in_ch_names ch_cfg.port_name];
+            config.in_ch_idx.(ch_cfg.port_name) = ch_cfg.port_id;
+        elseif(strcmp(strtrim(line{2}), 'OUT'))
+            ch_cfg.port_id = length(config.mon_ch) + 1;
+            config.mon_ch = [config.mon_ch ch_cfg];
+            config.out_ch_names = [config.out_ch_names ch_cfg.port_name];
+            config.out_ch_idx.(ch_cfg.port_name) = ch_cfg.port_id;
+        end
+    elseif(~isempty(strfind(line, 'data_in_device')))
+        % Get the associated data input device
+        idx = strfind(line, '=');
+        config.data_in_device = strtrim(line(idx+1:end));
+    elseif(~isempty(strfind(line, 'data_out_device')))
+        % Get the associated data output device
+        idx = strfind(line, '=');
+        config.data_out_device = strtrim(line(idx+1:end));
+    elseif(~isempty(strfind(line, 'ctrl_device')))
+        % Get the associated control device
+        idx = strfind(line, '=');
+        config.ctrl_device = strtrim(line(idx+1:end));
+    end
+end
+fclose(fp_cfg);
+
+% Save the compiled table
+save(cname, 'config');
+end
@@ -0,0 +1,53 @@
+function out = iio_ctx_cache(cmd, ip_address, varargin)
+% iio_ctx_cache Persistent discovery cache of the IIO network contexts
+%   iio_ctx_cache('open', ip, xml)          validates the cache entry against the context XML,
+%                                           returns 1 if the cached entries can be used
+%   iio_ctx_cache('get', ip, field)         returns a cached value, [] if not present
+%   iio_ctx_cache('set', ip, field, val)    stores a value and saves the cache to disk
+%   iio_ctx_cache('hash', [], str)          returns the MD5 hash of a string
+%   iio_ctx_cache('clear')                  removes all the entries
+persistent cache;
+cache_file = fullfile(tempdir, 'iio_ctx_cache.mat');
+out = [];
+
+if(strcmp(cmd, 'hash'))
+    md = java.security.MessageDigest.getInstance('MD5');
+    out = sprintf('%02x', typecast(md.digest(uint8(varargin{1})), 'uint8'));
+    return;
+end
+
+% Load the cache from disk on first use
+if(isempty(cache))
+    cache = struct();
+    if(exist(cache_file, 'file'))
+        tmp = load(cache_file);
+        cache = tmp.cache;
+    end
+end
+if(strcmp(cmd, 'clear'))
+    cache = struct();
+    save(cache_file, 'cache');
+    return;
+end
+key = matlab.lang.makeValidName(ip_address);
+
+switch(cmd)
+    case 'open'
+        % The cached channel maps are only valid for an identical context description
+        xml_hash = iio_ctx_cache('hash', [], varargin{1});
+        out = isfield(cache, key) && strcmp(cache.(key).xml_hash, xml_hash);
+        if(~out)
+            cache.(key) = struct('xml_hash', xml_hash, 'xml', varargin{1});
+            save(cache_file, 'cache');
+        end
+    case 'get'
+        field = matlab.lang.makeValidName(varargin{1});
+        if(isfield(cache, key) && isfield(cache.(key), field))
+            out = cache.(key).(field);
+        end
+    case 'set'
+        field = matlab.lang.makeValidName(varargin{1});
+        cache.(key).(field) = varargin{2};
+        save(cache_file, 'cache');
+end
+end
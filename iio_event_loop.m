@@ -0,0 +1,198 @@
+classdef iio_event_loop < handle
+    % iio_event_loop Completion-based asynchronous access to several IIO boards
+    %   The blocking libiio calls run on the parallel pool workers. Each worker
+    %   runs a server loop fed by its own PollableDataQueue; each board (IP
+    %   address) is owned by one worker, which keeps its iio_sys_obj_matlab
+    %   open between operations, so a few workers multiplex many boards and the
+    %   client thread is never blocked by iio_buffer_refill/push. The pool is
+    %   dedicated to the event loop until the object is deleted.
+    %   Operations are submitted as {op, args...} cells and executed in order on
+    %   the owning worker; a batch of operations costs a single round trip:
+    %       {'open', txWaveform, CenterFrequency, rmc}  iio_Hardware_setting on the worker,
+    %                                                   returns the TX scan element count
+    %       {'set', 'RX1_GAIN', 20}                     set a configuration input
+    %       {'step', txWaveform}                        stepImpl (TX push, RX refill, monitoring),
+    %                                                   txWaveform complex or interleaved int16
+    %       {'attr', 'calib_mode', 'manual'}            control device attribute write
+    %       {'close'}                                   releaseImpl
+    %   Completions are delivered through a DataQueue, optionally to a callback
+    %   f(id, results), where results holds one output per operation.
+
+    properties (SetAccess = private)
+        %pool Parallel pool running the blocking calls
+        pool = [];
+    end
+
+    properties (Access = private)
+        queue = [];             % DataQueue carrying the completions
+        pending = [];           % containers.Map id -> struct(done, results, callback)
+        owner = [];             % containers.Map IP address -> worker index
+        inbox = {};             % PollableDataQueue of each worker server
+        servers = [];           % Futures of the worker servers
+        next_id = 0;
+        next_worker = 0;
+    end
+
+    methods
+        function obj = iio_event_loop(num_workers)
+            % Start the event loop on a pool of num_workers workers
+            obj.pool = gcp('nocreate');
+            if(isempty(obj.pool))
+                obj.pool = parpool('local', num_workers);
+            end
+            obj.queue = parallel.pool.DataQueue;
+            afterEach(obj.queue, @(msg) complete(obj, msg));
+            obj.pending = containers.Map('KeyType', 'double', 'ValueType', 'any');
+            obj.owner = containers.Map();
+
+            % Start one server per worker, each sends back the queue it listens on
+            inbox_queue = parallel.pool.PollableDataQueue;
+            obj.servers = parfevalOnAll(obj.pool, @iio_event_loop.server, 0, obj.queue, inbox_queue);
+            obj.inbox = cell(1, obj.pool.NumWorkers);
+            for w = 1 : obj.pool.NumWorkers
+                [obj.inbox{w}, ok] = poll(inbox_queue, 60);
+                if(~ok)
+                    cancel(obj.servers);
+                    error('iio_event_loop: worker server %d did not start', w);
+                end
+            end
+        end
+
+        function delete(obj)
+            % Stop the worker servers, the boards still open are released
+            for w = 1 : length(obj.inbox)
+                send(obj.inbox{w}, []);
+            end
+            if(~isempty(obj.servers))
+                wait(obj.servers, 'finished', 10);
+                cancel(obj.servers);
+            end
+        end
+
+        function id = submit(obj, ip_address, ops, callback)
+            % Submit a batch of operations on one board, returns the completion ID
+            if(nargin < 4)
+                callback = [];
+            end
+            if(~iscell(ops{1}))
+                ops = {ops};
+            end
+            if(~isKey(obj.owner, ip_address))
+                obj.owner(ip_address) = mod(obj.next_worker, length(obj.inbox)) + 1;
+                obj.next_worker = obj.next_worker + 1;
+            end
+            obj.next_id = obj.next_id + 1;
+            id = obj.next_id;
+            obj.pending(id) = struct('done', 0, 'results', {{}}, 'callback', callback);
+            % Only the server owning the board receives the batch
+            send(obj.inbox{obj.owner(ip_address)}, {id, ip_address, ops});
+        end
+
+        function [done, results] = poll(obj, id)
+            % Non-blocking completion check
+            drawnow limitrate; % Let the DataQueue deliver the completions
+            entry = obj.pending(id);
+            done = entry.done;
+            results = entry.results;
+            if(done)
+                remove(obj.pending, id);
+            end
+        end
+
+        function results = wait(obj, id, timeout)
+            % Wait for the completion of a batch
+            if(nargin < 3)
+                timeout = inf;
+            end
+            t_start = tic;
+            [done, results] = poll(obj, id);
+            while(~done)
+                if(toc(t_start) > timeout)
+                    error('iio_event_loop: operation %d timed out', id);
+                end
+                pause(0.001);
+                [done, results] = poll(obj, id);
+            end
+        end
+    end
+
+    methods (Access = private)
+        function complete(obj, msg)
+            % Completion from a worker : msg = {id, results}
+            id = msg{1};
+            if(~isKey(obj.pending, id))
+                return;
+            end
+            entry = obj.pending(id);
+            entry.done = 1;
+            entry.results = msg{2};
+            obj.pending(id) = entry;
+            if(~isempty(entry.callback))
+                entry.callback(id, entry.results);
+            end
+        end
+    end
+
+    methods (Static)
+        function server(queue, inbox_queue)
+            % Worker server : executes the batches of the boards it owns, in order
+            inbox = parallel.pool.PollableDataQueue;
+            send(inbox_queue, inbox);
+            boards = containers.Map();
+            while(true)
+                [msg, ok] = poll(inbox, 1);
+                if(~ok)
+                    continue;
+                end
+                if(isempty(msg))
+                    break;
+                end
+                [results, boards] = iio_event_loop.execute(boards, msg{2}, msg{3});
+                send(queue, {msg{1}, results});
+            end
+            for ip_address = keys(boards)
+                b = boards(ip_address{1});
+                b.s.releaseImpl();
+            end
+        end
+
+        function [results, boards] = execute(boards, ip_address, ops)
+            % Executes a batch of operations on one board
+            results = cell(1, length(ops));
+            try
+                for k = 1 : length(ops)
+                    op = ops{k};
+                    switch(op{1})
+                        case 'open'
+                            [s, input] = iio_Hardware_setting(ip_address, op{2}, op{3}, op{4});
+                            boards(ip_address) = struct('s', s, 'input', {input});
+                            results{k} = s.getTxScanElements();
+                        case 'set'
+                            b = boards(ip_address);
+                            b.input{b.s.getInChannel(op{2})} = op{3};
+                            boards(ip_address) = b;
+                        case 'step'
+                            b = boards(ip_address);
+                            if(length(op) > 1 && isa(op{2}, 'int16'))
+                                b.input{1} = op{2}; % Interleaved in scan order (Waveform_Library)
+                                b.input{2} = [];
+                            elseif(length(op) > 1)
+                                b.input{1} = real(op{2});
+                                b.input{2} = imag(op{2});
+                            end
+                            results{k} = stepImpl(b.s, b.input);
+                        case 'attr'
+                            b = boards(ip_address);
+                            results{k} = b.s.writeCtrlAttribute(op{2}, op{3});
+                        case 'close'
+                            b = boards(ip_address);
+                            b.s.releaseImpl();
+                            remove(boards, ip_address);
+                    end
+                end
+            catch exception
+                results{end} = exception;
+            end
+        end
+    end
+end
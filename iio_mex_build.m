@@ -0,0 +1,22 @@
+function iio_mex_build(inc_dir, lib_dir)
+% iio_mex_build Compile libiio_mex.c, the native data path of libiio_if
+%   iio_mex_build() links against the libiio installed in the default
+%   system paths, iio_mex_build(inc_dir, lib_dir) against the iio.h and
+%   libiio library found in the given directories. Once libiio_mex is on
+%   the path, libiio_if refills and pushes the buffers through it and
+%   iio_sys_obj_matlab reads the monitoring attributes in one call.
+%   Delete the compiled file to go back to the calllib data path.
+if(nargin < 1)
+    inc_dir = pwd;
+end
+args = {'-R2018a', ['-I' inc_dir], 'libiio_mex.c'};
+if(nargin >= 2)
+    args = [args {['-L' lib_dir]}];
+end
+if(ispc)
+    args = [args {'-llibiio'}];
+else
+    args = [args {'-liio'}];
+end
+mex(args{:});
+clear libiio_mex;
\ No newline at end of file
@@ -78,6 +78,9 @@ classdef iio_sys_obj_matlab
         
         %sys_obj_initialized Holds the initialization status of the system object
         sys_obj_initialized = 0;
+        
+        %mon_spec Monitoring attributes read in one libiio_mex call, empty to use calllib
+        mon_spec = [];
     end
     
     properties (Access = private)
@@ -104,79 +107,8 @@ classdef iio_sys_obj_matlab
         %% Utility functions
         
         function config = getObjConfig(obj)
-            % Read the selected device configuration
-            
-            % Open the configuration file
-            fname = sprintf('%s.cfg', obj.dev_name);
-            fp_cfg = fopen(fname);
-            if(fp_cfg < 0)
-                config = {};
-                return;
-            end
-            
-            % Build the object configuration structure
-            config = struct('data_in_device', '',... 	% Pointer to the data input device
-                'data_out_device', '',...	% Pointer to the data output device
-                'ctrl_device', '',... 	 	% Pointer to the control device
-                'cfg_ch', [],...      	 	% Configuration channels list
-                'mon_ch', [],...       	 	% Monitoring channels list
-				'in_ch_names', [],...		% Configuration channels names
-				'out_ch_names', []);		% Monitoring channels names
-            config.in_ch_names = {};
-			config.out_ch_names = {};
-			
-            % Build the configuration/monitoring channels structure
-            ch_cfg = struct('port_name', '',...         % Name of the port to be displayed on the object block
-                'port_attr', '',...         % Associated device attribute name
-                'ctrl_dev_name', '',...     % Control device name
-                'ctrl_dev', 0);             % Pointer to the control device object
-            
-            % Read the object's configuration
-            while(~feof(fp_cfg))
-                line = fgets(fp_cfg);
-                if(strfind(line,'#'))
-                    continue;
-                end
-                if(~isempty(strfind(line, 'channel')))
-                    % Get the associated configuration/monitoring channels
-                    idx = strfind(line, '=');
-                    line = line(idx+1:end);
-                    line = strsplit(line, ',');
-                    ch_cfg.port_name = strtrim(line{1});
-                    ch_cfg.port_attr = strtrim(line{3});
-                    if(length(line) > 4)
-                        ch_cfg.ctrl_dev_name = strtrim(line{4});
-                    else
-                        ch_cfg.ctrl_dev_name = 'ctrl_device';
-                    end
-                    if(strcmp(strtrim(line{2}), 'IN'))
-                        config.cfg_ch = [config.cfg_ch ch_cfg];
-						config.in_ch_names = [config.in_ch_names ch_cfg.port_name];
-                    elseif(strcmp(strtrim(line{2}), 'OUT'))
-                        config.mon_ch = [config.mon_ch ch_cfg];
-						config.out_ch_names = [config.out_ch_names ch_cfg.port_name];
-                    end
-                elseif(~isempty(strfind(line, 'data_in_device')))
-                    % Get the associated data input device
-                    idx = strfind(line, '=');
-                    tmp = line(idx+1:end);
-                    tmp = strtrim(tmp);
-                    config.data_in_device = tmp;
-                elseif(~isempty(strfind(line, 'data_out_device')))
-                    % Get the associated data output device
-                    idx = strfind(line, '=');
-                    tmp = line(idx+1:end);
-                    tmp = strtrim(tmp);
-                    config.data_out_device = tmp;
-                elseif(~isempty(strfind(line, 'ctrl_device')))
-                    % Get the associated control device
-                    idx = strfind(line, '=');
-                    tmp = line(idx+1:end);
-                    tmp = strtrim(tmp);
-                    config.ctrl_device = tmp;
-                end
-            end
-            fclose(fp_cfg);
+            % Read the selected device configuration from its compiled table
+            config = iio_cfg_compile(obj.dev_name);
         end
         
     end
@@ -185,12 +117,12 @@ classdef iio_sys_obj_matlab
         %% Helper functions
 		function ret = getInChannel(obj, channelName)
             % Returns the index of a named input channel
-			ret = obj.in_ch_no + find(strcmp(obj.iio_dev_cfg.in_ch_names, channelName));
+			ret = obj.in_ch_no + obj.iio_dev_cfg.in_ch_idx.(channelName);
 		end
 		
 		function ret = getOutChannel(obj, channelName)
             % Returns the index of a named output channel
-			ret = obj.out_ch_no + find(strcmp(obj.iio_dev_cfg.out_ch_names, channelName));
+			ret = obj.out_ch_no + obj.iio_dev_cfg.out_ch_idx.(channelName);
 		end
 		
 		%% Common functions
@@ -256,6 +188,25 @@ classdef iio_sys_obj_matlab
                 else
                     obj.iio_dev_cfg.mon_ch(i).ctrl_dev = obj.libiio_ctrl_dev;
                 end
+                obj.iio_dev_cfg.mon_ch(i).attr_handle = resolveAttribute(obj.iio_dev_cfg.mon_ch(i).ctrl_dev, obj.iio_dev_cfg.mon_ch(i).port_attr);
+            end
+            
+            % Batch the monitoring reads when the data path was opened through
+            % libiio_mex and every attribute can be named. The context is held
+            % by the object until releaseImpl, not created per read
+            obj.mon_spec = [];
+            if(isMexDataPath(obj.libiio_data_in_dev) || isMexDataPath(obj.libiio_data_out_dev))
+                for i = 1 : length(obj.iio_dev_cfg.mon_ch)
+                    spec = attributeSpec(obj.iio_dev_cfg.mon_ch(i).ctrl_dev, obj.iio_dev_cfg.mon_ch(i).attr_handle);
+                    if(isempty(spec))
+                        obj.mon_spec = [];
+                        break;
+                    end
+                    obj.mon_spec = [obj.mon_spec spec];
+                end
+                if(~isempty(obj.mon_spec))
+                    libiio_mex('ctx_open', obj.ip_address);
+                end
             end
             
             % Assign the control device for each configuration channel
@@ -267,6 +218,7 @@ classdef iio_sys_obj_matlab
                 else
                     obj.iio_dev_cfg.cfg_ch(i).ctrl_dev = obj.libiio_ctrl_dev;
                 end
+                obj.iio_dev_cfg.cfg_ch(i).attr_handle = resolveAttribute(obj.iio_dev_cfg.cfg_ch(i).ctrl_dev, obj.iio_dev_cfg.cfg_ch(i).port_attr);
             end
             
             % Set the initialization status to success
@@ -276,6 +228,9 @@ classdef iio_sys_obj_matlab
         
         function releaseImpl(obj)
             % Release any resources used by the system object.
+            if(~isempty(obj.mon_spec))
+                libiio_mex('ctx_close', obj.ip_address);
+            end
             obj.iio_dev_cfg = {};
             delete(obj.libiio_data_in_dev);
             delete(obj.libiio_data_out_dev);
@@ -290,6 +245,7 @@ classdef iio_sys_obj_matlab
             end
             
             % Implement the device configuration flow
+            t = Trace_Recorder.begin();
             for i = 1 : length(obj.iio_dev_cfg.cfg_ch)
                 if(~isempty(varargin{1}{i + obj.in_ch_no}))
                     if(length(varargin{1}{i + obj.in_ch_no}) == 1)
@@ -300,40 +256,126 @@ classdef iio_sys_obj_matlab
                     if(new_data == 1)
                         if(length(varargin{1}{i + obj.in_ch_no}) == 1)
                             obj.num_cfg_in(i) = varargin{1}{i + obj.in_ch_no};
-                            str = num2str(obj.num_cfg_in(i));
+                            writeAttributeNumberHandle(obj.iio_dev_cfg.cfg_ch(i).ctrl_dev, obj.iio_dev_cfg.cfg_ch(i).attr_handle, obj.num_cfg_in(i));
                         else
                             for j = 1:length(varargin{1}{i + obj.in_ch_no})
                                 obj.str_cfg_in(i,j) = varargin{1}{i + obj.in_ch_no}(j);
                             end
                             obj.str_cfg_in(i,j+1) = 0;
                             str = char(obj.str_cfg_in(i,:));
+                            writeAttributeStringHandle(obj.iio_dev_cfg.cfg_ch(i).ctrl_dev, obj.iio_dev_cfg.cfg_ch(i).attr_handle, str);
                         end
-                        writeAttributeString(obj.iio_dev_cfg.cfg_ch(i).ctrl_dev, obj.iio_dev_cfg.cfg_ch(i).port_attr, str);
                     end
                 end
             end
             
+            Trace_Recorder.finish('stepImpl/config', t);
+            
             % Implement the data transmit flow
+            t = Trace_Recorder.begin();
             writeData(obj.libiio_data_in_dev, varargin{1});
+            Trace_Recorder.finish('stepImpl/writeData', t);
             
             % Implement the data capture flow
+            t = Trace_Recorder.begin();
             [~, data] = readData(obj.libiio_data_out_dev);
+            Trace_Recorder.finish('stepImpl/readData', t);
             for i = 1 : obj.out_ch_no
                 varargout{i} = data{i};
             end
             
             % Implement the parameters monitoring flow
-            for i = 1 : length(obj.iio_dev_cfg.mon_ch)
-                [~, val] = readAttributeDouble(obj.iio_dev_cfg.mon_ch(i).ctrl_dev, obj.iio_dev_cfg.mon_ch(i).port_attr);
-                varargout{obj.out_ch_no + i} = val;
+            t = Trace_Recorder.begin();
+            if(~isempty(obj.mon_spec))
+                vals = libiio_mex('read_attrs', obj.ip_address, obj.mon_spec);
+                varargout(obj.out_ch_no + (1 : length(vals))) = num2cell(vals');
+            else
+                for i = 1 : length(obj.iio_dev_cfg.mon_ch)
+                    [~, val] = readAttributeDoubleHandle(obj.iio_dev_cfg.mon_ch(i).ctrl_dev, obj.iio_dev_cfg.mon_ch(i).attr_handle);
+                    varargout{obj.out_ch_no + i} = val;
+                end
             end
+            Trace_Recorder.finish('stepImpl/monitor', t);
             
             ret=varargout;
         end
         
+        function fmt = getOutDataFormat(obj)
+            % Returns the iio_data_format of the captured samples
+            [~, fmt] = getDataFormat(obj.libiio_data_out_dev);
+        end
+        
+        function n = getTxScanElements(obj)
+            % Scan elements per sample of the TX buffer, layout of the Waveform_Library entries
+            n = getScanElementCount(obj.libiio_data_in_dev);
+        end
+        
+        function ret = writeCfgChannel(obj, channelName, val)
+            % Write a configuration input now, outside the stepImpl flow.
+            % Leave its stepImpl input empty, stepImpl rewrites every non-empty input
+            cfg = obj.iio_dev_cfg.cfg_ch(obj.iio_dev_cfg.in_ch_idx.(channelName));
+            if(ischar(val))
+                ret = writeAttributeStringHandle(cfg.ctrl_dev, cfg.attr_handle, val);
+            else
+                ret = writeAttributeNumberHandle(cfg.ctrl_dev, cfg.attr_handle, val);
+            end
+        end
+
+        function ret = flushCapture(obj)
+            % Drop the captures queued by the RX buffer, the next stepImpl
+            % returns samples taken after the flush
+            ret = flushInputBuffer(obj.libiio_data_out_dev);
+        end
+        
+        function ret = writeCtrlAttribute(obj, attr_name, str)
+            % Write a string attribute of the control device
+            ret = writeAttributeString(obj.libiio_ctrl_dev, attr_name, str);
+        end
+        
+        function ret = writeCtrlDebugAttribute(obj, attr_name, str)
+            % Write a string debug attribute of the control device
+            ret = writeDebugAttributeString(obj.libiio_ctrl_dev, attr_name, str);
+        end
+        
+        function ret = writeCtrlRegister(obj, address, value)
+            % Write a register of the control device
+            ret = writeRegister(obj.libiio_ctrl_dev, address, value);
+        end
+
+        function ret = setCaptureTrigger(obj, trigger_name)
+            % Trigger the capture device from an IIO trigger, '' : free running
+            ret = setTrigger(obj.libiio_data_out_dev, trigger_name);
+        end
+
+        function [ret, trigger_name] = getCaptureTrigger(obj)
+            % Name of the IIO trigger of the capture device, '' : free running
+            [ret, trigger_name] = getTrigger(obj.libiio_data_out_dev);
+        end
+        
         function ret = writeFirData(obj, fir_data_file)
             fir_data_str = fileread(fir_data_file);
+            fir_hash = iio_ctx_cache('hash', [], fir_data_str);
+            
+            % Skip the upload if the same coefficients are already loaded
+            if(strcmp(iio_ctx_cache('get', obj.ip_address, 'fir_hash'), fir_hash))
+                tx = regexp(fir_data_str, 'TX\s+\d+\s+GAIN\s+-?\d+\s+INT\s+(\d+)', 'tokens', 'once');
+                rx = regexp(fir_data_str, 'RX\s+\d+\s+GAIN\s+-?\d+\s+DEC\s+(\d+)', 'tokens', 'once');
+                taps = length(regexp(fir_data_str, '^\s*-?\d+\s*,\s*-?\d+\s*$', 'lineanchors'));
+                [ret, fir_cfg] = readAttributeString(obj.libiio_ctrl_dev, 'filter_fir_config');
+                if((ret >= 0) && ~isempty(tx) && ~isempty(rx))
+                    fir_num = sscanf(fir_cfg, 'FIR Rx: %d,%d Tx: %d,%d');
+                    if(isequal(fir_num(:).', [taps str2double(rx{1}) taps str2double(tx{1})]))
+                        fprintf('%s: FIR coefficients already loaded\n', class(obj));
+                        ret = 0;
+                        return;
+                    end
+                end
+            end
+            
             ret = writeAttributeString(obj.libiio_ctrl_dev, 'filter_fir_config', fir_data_str);
+            if(ret >= 0)
+                iio_ctx_cache('set', obj.ip_address, 'fir_hash', fir_hash);
+            end
         end
     end
 end
\ No newline at end of file
@@ -41,6 +41,7 @@ classdef libiio_if < handle
     properties (Access = protected)
         libname         = 'libiio';
         hname           = 'iio.h';
+        ip_address      = '';
         dev_name        = '';
         data_ch_no      = 0;
         data_ch_size    = 0;
@@ -52,6 +53,9 @@ classdef libiio_if < handle
         iio_buf_size    = 8192;
         iio_scan_elm_no = 0;
         if_initialized  = 0;
+        ctx_shared      = 0;
+        ctx_cached      = 0;
+        mex_handle      = 0;
     end
 
     %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -67,6 +71,39 @@ classdef libiio_if < handle
             instance_cnt = instance_cnt + val;
             out = instance_cnt;
         end
+
+        function out = useMex()
+            % Checks once if the compiled libiio_mex data path is available (iio_mex_build)
+            persistent has_mex;
+            if isempty(has_mex)
+                has_mex = (exist('libiio_mex', 'file') == 3);
+            end
+            out = has_mex;
+        end
+
+        function [ctx, ref_cnt] = modSharedContext(ip_address, ctx, val)
+            % Manages the network contexts shared by the objects connected to the same IP address.
+            % val = 1 acquires the context (registers ctx if none is open), val = -1 releases it.
+            persistent ctx_list;
+            if isempty(ctx_list)
+                ctx_list = containers.Map();
+            end
+            ref_cnt = 0;
+            if isKey(ctx_list, ip_address)
+                entry = ctx_list(ip_address);
+                entry.ref_cnt = entry.ref_cnt + val;
+                ctx = entry.ctx;
+                ref_cnt = entry.ref_cnt;
+                if(ref_cnt == 0)
+                    remove(ctx_list, ip_address);
+                else
+                    ctx_list(ip_address) = entry;
+                end
+            elseif((val > 0) && ~isempty(ctx))
+                ctx_list(ip_address) = struct('ctx', ctx, 'ref_cnt', 1);
+                ref_cnt = 1;
+            end
+        end
     end
 
     %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -82,19 +119,34 @@ classdef libiio_if < handle
             err_msg = '';
             msg_log = [];
 
-            % Create the network context
-            obj.iio_ctx = calllib(obj.libname, 'iio_create_network_context', ip_address);
-
-            % Check if the network context is valid
-            if (isNull(obj.iio_ctx))
-                obj.iio_ctx = {};
-                err_msg = 'Could not connect to the IIO server!';
-                return;
+            % Reuse the context already opened by another object for the same IP address
+            obj.ip_address = ip_address;
+            [obj.iio_ctx, ref_cnt] = libiio_if.modSharedContext(ip_address, {}, 1);
+            obj.ctx_shared = (ref_cnt > 1);
+            if(~obj.ctx_shared)
+                % Create the network context
+                obj.iio_ctx = calllib(obj.libname, 'iio_create_network_context', ip_address);
+
+                % Check if the network context is valid
+                if (isNull(obj.iio_ctx))
+                    obj.iio_ctx = {};
+                    err_msg = 'Could not connect to the IIO server!';
+                    return;
+                end
+                libiio_if.modSharedContext(ip_address, obj.iio_ctx, 1);
             end
 
+            % Validate the discovery cache against the context description
+            xml = calllib(obj.libname, 'iio_context_get_xml', obj.iio_ctx);
+            obj.ctx_cached = iio_ctx_cache('open', ip_address, xml);
+
             % Increase the object's instance count
             libiio_if.modInstanceCnt(1);
-            msg_log = [msg_log sprintf('%s: Connected to IP %s\n', class(obj), ip_address)];
+            if(obj.ctx_shared)
+                msg_log = [msg_log sprintf('%s: Reusing the context of IP %s\n', class(obj), ip_address)];
+            else
+                msg_log = [msg_log sprintf('%s: Connected to IP %s\n', class(obj), ip_address)];
+            end
 
             % Set the return code to success
             ret = 0;
@@ -104,7 +156,10 @@ classdef libiio_if < handle
         %% Releases the network context and unload the libiio library
         %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
         function releaseContext(obj)
-            calllib(obj.libname, 'iio_context_destroy', obj.iio_ctx);
+            [~, ref_cnt] = libiio_if.modSharedContext(obj.ip_address, {}, -1);
+            if(ref_cnt == 0)
+                calllib(obj.libname, 'iio_context_destroy', obj.iio_ctx);
+            end
             obj.iio_ctx = {};
             instCnt = libiio_if.modInstanceCnt(-1);
             if(instCnt == 0)
@@ -181,20 +236,11 @@ classdef libiio_if < handle
             msg_log = [msg_log sprintf('%s: Found %d devices in the system\n', class(obj), nb_devices)];
 
             % Detect if the targeted device is installed
-            dev_found = 0;
-            for i = 0 : nb_devices - 1
-                dev = calllib(obj.libname, 'iio_context_get_device', obj.iio_ctx, i);
-                name = calllib(obj.libname, 'iio_device_get_name', dev);
-                if(strcmp(name, dev_name))
-                    obj.iio_dev = dev;
-                    dev_found = 1;
-                    break;
-                end
-                clear dev;
-            end
+            obj.iio_dev = calllib(obj.libname, 'iio_context_find_device', obj.iio_ctx, dev_name);
 
             % Check if the target device was detected
-            if(dev_found == 0)
+            if(isNull(obj.iio_dev))
+                obj.iio_dev = {};
                 err_msg = 'Could not find target configuration device!';
                 return;
             end
@@ -236,15 +282,27 @@ classdef libiio_if < handle
                     err_msg = 'The selected device does not have output channels!';
                     return;
                 end
-                % Enable all the channels
+                % Enable all the channels, the number of scan elements
+                % is taken from the discovery cache when available
+                scan_elm_no = [];
+                if(obj.ctx_cached)
+                    scan_elm_no = iio_ctx_cache('get', obj.ip_address, [obj.dev_name '_scan_elm_no']);
+                end
                 for j = 0 : nb_channels - 1
                     obj.iio_channel{j+1} = calllib(obj.libname, 'iio_device_get_channel', obj.iio_dev, j);
                     calllib(obj.libname, 'iio_channel_enable', obj.iio_channel{j+1});
-                    is_scan_element = calllib(obj.libname, 'iio_channel_is_scan_element', obj.iio_channel{j+1});
-                    if(is_scan_element == 1)
-                        obj.iio_scan_elm_no = obj.iio_scan_elm_no + 1;
+                    if(isempty(scan_elm_no))
+                        is_scan_element = calllib(obj.libname, 'iio_channel_is_scan_element', obj.iio_channel{j+1});
+                        if(is_scan_element == 1)
+                            obj.iio_scan_elm_no = obj.iio_scan_elm_no + 1;
+                        end
                     end
                 end
+                if(isempty(scan_elm_no))
+                    iio_ctx_cache('set', obj.ip_address, [obj.dev_name '_scan_elm_no'], obj.iio_scan_elm_no);
+                else
+                    obj.iio_scan_elm_no = scan_elm_no;
+                end
                 msg_log = [msg_log sprintf('%s: Found %d output channels for the device %s\n', class(obj), obj.iio_scan_elm_no, obj.dev_name)];
 
                 % Check if the number of channels in the device
@@ -266,10 +324,22 @@ classdef libiio_if < handle
                     return;
                 end
 
-                % Create the IIO buffer used to write data
+                % Create the IIO buffer used to write data, the MEX
+                % data path creates its buffer on the first push
                 obj.iio_buf_size = obj.data_ch_size * obj.iio_scan_elm_no;
-                obj.iio_buffer = calllib(obj.libname, 'iio_device_create_buffer', obj.iio_dev,...
-                                         obj.data_ch_size, 1);
+                if(libiio_if.useMex())
+                    try
+                        obj.mex_handle = libiio_mex('open', obj.ip_address, obj.dev_name, ...
+                                                    0 : nb_channels - 1, obj.data_ch_size, 1);
+                        msg_log = [msg_log sprintf('%s: %s output data path opened through libiio_mex\n', class(obj), obj.dev_name)];
+                    catch exception
+                        msg_log = [msg_log sprintf('%s: libiio_mex unavailable (%s)\n', class(obj), exception.message)];
+                    end
+                end
+                if(obj.mex_handle == 0)
+                    obj.iio_buffer = calllib(obj.libname, 'iio_device_create_buffer', obj.iio_dev,...
+                                             obj.data_ch_size, 1);
+                end
             end
 
             msg_log = [msg_log sprintf('%s: %s output data channels successfully initialized\n', class(obj), obj.dev_name)];
@@ -329,9 +399,22 @@ classdef libiio_if < handle
                     obj.iio_channel{j+1} = calllib(obj.libname, 'iio_device_get_channel', obj.iio_dev, j);
                     calllib(obj.libname, 'iio_channel_disable', obj.iio_channel{j+1});
                 end
-                % Create the IIO buffer used to read data
+                % Create the IIO buffer used to read data. The MEX data
+                % path sizes its buffer to the channel size, the calllib
+                % buffer holds data_ch_no times more samples than used
                 obj.iio_buf_size = obj.data_ch_size * obj.data_ch_no;
-                obj.iio_buffer = calllib(obj.libname, 'iio_device_create_buffer', obj.iio_dev, obj.iio_buf_size, 0);
+                if(libiio_if.useMex())
+                    try
+                        obj.mex_handle = libiio_mex('open', obj.ip_address, obj.dev_name, ...
+                                                    0 : ch_no - 1, obj.data_ch_size, 0);
+                        msg_log = [msg_log sprintf('%s: %s input data path opened through libiio_mex\n', class(obj), obj.dev_name)];
+                    catch exception
+                        msg_log = [msg_log sprintf('%s: libiio_mex unavailable (%s)\n', class(obj), exception.message)];
+                    end
+                end
+                if(obj.mex_handle == 0)
+                    obj.iio_buffer = calllib(obj.libname, 'iio_device_create_buffer', obj.iio_dev, obj.iio_buf_size, 0);
+                end
             end
 
             msg_log = [msg_log sprintf('%s: %s input data channels successfully initialized\n', class(obj), obj.dev_name)];
@@ -361,11 +444,18 @@ classdef libiio_if < handle
         function delete(obj)
             % Release any resources used by the system object.
             if((obj.if_initialized == 1) && libisloaded(obj.libname))
+                if(obj.mex_handle > 0)
+                    libiio_mex('close', obj.mex_handle);
+                    obj.mex_handle = 0;
+                end
                 if(~isempty(obj.iio_buffer))
                     calllib(obj.libname, 'iio_buffer_destroy', obj.iio_buffer);
                 end
                 if(~isempty(obj.iio_ctx))
-                    calllib(obj.libname, 'iio_context_destroy', obj.iio_ctx);
+                    [~, ref_cnt] = libiio_if.modSharedContext(obj.ip_address, {}, -1);
+                    if(ref_cnt == 0)
+                        calllib(obj.libname, 'iio_context_destroy', obj.iio_ctx);
+                    end
                 end
                 obj.iio_buffer = {};
                 obj.iio_channel = {};
@@ -416,12 +506,14 @@ classdef libiio_if < handle
                 return;
             end
 
-            % Check the software versions
-            [ret, err_msg, msg_log_new] = checkVersions(obj);
-            msg_log = [msg_log msg_log_new];
-            if(ret < 0)
-                releaseContext(obj);
-                return;
+            % Check the software versions, once per context
+            if(~obj.ctx_shared)
+                [ret, err_msg, msg_log_new] = checkVersions(obj);
+                msg_log = [msg_log msg_log_new];
+                if(ret < 0)
+                    releaseContext(obj);
+                    return;
+                end
             end
 
             % Initialize the device
@@ -464,7 +556,7 @@ classdef libiio_if < handle
             ret = -1;
             data = cell(1, obj.data_ch_no);
             for i = 1 : obj.data_ch_no
-                data{i} = zeros(obj.data_ch_size, 1);
+                data{i} = zeros(obj.data_ch_size, 1, 'int16');
             end
 
             % Check if the interface is initialized
@@ -477,13 +569,82 @@ classdef libiio_if < handle
                 return;
             end
 
-            % Read the data
+            % Read the data, the MEX data path de-interleaves the channels
+            % while copying them out of the buffer
+            if(obj.mex_handle > 0)
+                t = Trace_Recorder.begin();
+                [data{1 : obj.data_ch_no}] = libiio_mex('refill', obj.mex_handle);
+                Trace_Recorder.finish('libiio/mex_refill', t);
+                Trace_Recorder.count('refills', 1);
+                Trace_Recorder.count('rx_bytes', 2*obj.iio_buf_size);
+                ret = 0;
+                return;
+            end
+            t = Trace_Recorder.begin();
             calllib(obj.libname, 'iio_buffer_refill', obj.iio_buffer);
+            Trace_Recorder.finish('libiio/refill', t);
+            Trace_Recorder.count('refills', 1);
+            Trace_Recorder.count('rx_bytes', 2*obj.iio_buf_size);
+            t = Trace_Recorder.begin();
             buffer = calllib(obj.libname, 'iio_buffer_first', obj.iio_buffer, obj.iio_channel{1});
             setdatatype(buffer, 'int16Ptr', obj.iio_buf_size);
+            % Keep the native int16 samples, the conversion is left to the receiver
+            samples = buffer.Value;
             for i = 1 : obj.data_ch_no
-                data{i} = double(buffer.Value(i:obj.data_ch_no:end));
+                data{i} = samples(i:obj.data_ch_no:end);
             end
+            Trace_Recorder.finish('libiio/rx_copy', t);
+
+            % Set the return code to success
+            ret = 0;
+        end
+
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        %% Drop the data blocks queued by the input buffer
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        function ret = flushInputBuffer(obj)
+            % Initialize the return value
+            ret = -1;
+
+            % Check if the interface is initialized
+            if((obj.if_initialized == 0) || ~strcmp(obj.dev_type, 'IN'))
+                return;
+            end
+
+            % The buffer is created again, the next refill returns samples
+            % captured after the flush
+            t = Trace_Recorder.begin();
+            if(obj.mex_handle > 0)
+                libiio_mex('flush', obj.mex_handle);
+            else
+                calllib(obj.libname, 'iio_buffer_destroy', obj.iio_buffer);
+                obj.iio_buffer = calllib(obj.libname, 'iio_device_create_buffer', obj.iio_dev, obj.iio_buf_size, 0);
+            end
+            Trace_Recorder.finish('libiio/flush', t);
+
+            % Set the return code to success
+            ret = 0;
+        end
+
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        %% Get the sample format of the first data channel
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        function [ret, fmt] = getDataFormat(obj)
+            % Initialize the return values
+            ret = -1;
+            fmt = struct('length', 16, 'bits', 16, 'shift', 0, 'is_signed', 1);
+
+            % Check if the interface is initialized
+            if((obj.if_initialized == 0) || isempty(obj.iio_channel))
+                return;
+            end
+
+            % Read the iio_data_format structure
+            pFmt = calllib(obj.libname, 'iio_channel_get_data_format', obj.iio_channel{1});
+            fmt.length = double(pFmt.Value.length);
+            fmt.bits = double(pFmt.Value.bits);
+            fmt.shift = double(pFmt.Value.shift);
+            fmt.is_signed = double(pFmt.Value.is_signed);
 
             % Set the return code to success
             ret = 0;
@@ -506,9 +667,19 @@ classdef libiio_if < handle
                 return;
             end
 
+            % A single int16 entry must already be interleaved in scan element order
+            if(isa(data{1}, 'int16') && ((length(data) < 2) || isempty(data{2})) && ...
+                    (numel(data{1}) ~= obj.data_ch_size * obj.iio_scan_elm_no))
+                error('libiio_if: interleaved TX data holds %d values, %d samples x %d scan elements expected', ...
+                    numel(data{1}), obj.data_ch_size, obj.iio_scan_elm_no);
+            end
+
             % Destroy the buffer
-            calllib(obj.libname, 'iio_buffer_destroy', obj.iio_buffer);
-            obj.iio_buffer = {};
+            t = Trace_Recorder.begin();
+            if(obj.mex_handle == 0)
+                calllib(obj.libname, 'iio_buffer_destroy', obj.iio_buffer);
+                obj.iio_buffer = {};
+            end
 
             % Enable the DAC buffer output
             ret = writeAttributeString(obj, 'altvoltage0*raw', '0');
@@ -518,21 +689,51 @@ classdef libiio_if < handle
                 return;
             end
 
+            % The MEX data path recreates the cyclic buffer and
+            % interleaves the channels in a single call
+            if(obj.mex_handle > 0)
+                Trace_Recorder.finish('libiio/tx_buffer_create', t);
+                t = Trace_Recorder.begin();
+                if(isa(data{1}, 'int16') && numel(data{1}) == obj.iio_buf_size)
+                    libiio_mex('push', obj.mex_handle, data{1});
+                else
+                    libiio_mex('push', obj.mex_handle, data{1 : obj.data_ch_no});
+                end
+                Trace_Recorder.finish('libiio/mex_push', t);
+                Trace_Recorder.count('pushes', 1);
+                Trace_Recorder.count('tx_bytes', 2*obj.iio_buf_size);
+                ret = 0;
+                return;
+            end
+
             % Create the IIO buffer used to write data
             obj.iio_buf_size = obj.data_ch_size * obj.iio_scan_elm_no;
             obj.iio_buffer = calllib(obj.libname, 'iio_device_create_buffer', obj.iio_dev,...
                                      obj.data_ch_size, 1);
 
+            Trace_Recorder.finish('libiio/tx_buffer_create', t);
+
             % Transmit the data
+            t = Trace_Recorder.begin();
             buffer = calllib(obj.libname, 'iio_buffer_start', obj.iio_buffer);
             setdatatype(buffer, 'int16Ptr', obj.iio_buf_size);
-            for i = 1 : obj.data_ch_no
-                buffer.Value(i : obj.iio_scan_elm_no : obj.iio_buf_size) = int16(data{i});
-            end
-            for i = obj.data_ch_no + 1 : obj.iio_scan_elm_no
-                buffer.Value(i : obj.iio_scan_elm_no : obj.iio_buf_size) = 0;
+            if(isa(data{1}, 'int16') && numel(data{1}) == obj.iio_buf_size)
+                % Already interleaved in scan element order (Waveform_Library)
+                buffer.Value = data{1};
+            else
+                for i = 1 : obj.data_ch_no
+                    buffer.Value(i : obj.iio_scan_elm_no : obj.iio_buf_size) = int16(data{i});
+                end
+                for i = obj.data_ch_no + 1 : obj.iio_scan_elm_no
+                    buffer.Value(i : obj.iio_scan_elm_no : obj.iio_buf_size) = 0;
+                end
             end
+            Trace_Recorder.finish('libiio/tx_copy', t);
+            t = Trace_Recorder.begin();
             calllib(obj.libname, 'iio_buffer_push', obj.iio_buffer);
+            Trace_Recorder.finish('libiio/push', t);
+            Trace_Recorder.count('pushes', 1);
+            Trace_Recorder.count('tx_bytes', 2*obj.iio_buf_size);
 
             % Set the return code to success
             ret = 0;
@@ -601,6 +802,13 @@ classdef libiio_if < handle
                     break;
                 end
             end
+
+            % The attribute does not exist
+            if(isempty(ret) || (ret ~= 1))
+                ret = -1;
+                ch = 0;
+                attr = '';
+            end
         end
 
         %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -664,13 +872,13 @@ classdef libiio_if < handle
                 return;
             end
 
-            % Write the attribute
+            % Write the attribute, returns 0 or a negative error code
             if(ret > 0)
-                calllib(obj.libname, 'iio_channel_attr_write_double', ch, attr, val);
+                ret = calllib(obj.libname, 'iio_channel_attr_write_double', ch, attr, val);
                 clear ch;
                 clear attr;
             else
-                calllib(obj.libname, 'iio_device_attr_write_double', obj.iio_dev, attr_name, val);
+                ret = calllib(obj.libname, 'iio_device_attr_write_double', obj.iio_dev, attr_name, val);
             end
         end
 
@@ -684,14 +892,212 @@ classdef libiio_if < handle
                 return;
             end
 
-            % Write the attribute
+            % Write the attribute, returns the bytes written or a negative error code
             if(ret > 0)
-                calllib(obj.libname, 'iio_channel_attr_write', ch, attr, str);
+                ret = calllib(obj.libname, 'iio_channel_attr_write', ch, attr, str);
                 clear ch;
                 clear attr;
             else
-                calllib(obj.libname, 'iio_device_attr_write', obj.iio_dev, attr_name, str);
+                ret = calllib(obj.libname, 'iio_device_attr_write', obj.iio_dev, attr_name, str);
+            end
+        end
+
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        %% Resolve an attribute once so it can be accessed without any name lookup
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        function h = resolveAttribute(obj, attr_name)
+            [ret, ch, attr] = findAttribute(obj, attr_name);
+            if(ret == 0)
+                attr = attr_name;
+            end
+            h = struct('ret', ret, 'ch', ch, 'attr', attr);
+        end
+
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        %% Get the number of scan elements of an output device
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        function n = getScanElementCount(obj)
+            n = obj.iio_scan_elm_no;
+        end
+
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        %% Check if the data buffer was opened through libiio_mex
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        function ret = isMexDataPath(obj)
+            ret = (obj.mex_handle > 0);
+        end
+
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        %% Describe a resolved attribute by name for the batched libiio_mex reads
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        function spec = attributeSpec(obj, h)
+            spec = [];
+            if((h.ret < 0) || ~libiio_if.useMex())
+                return;
+            end
+            spec = struct('dev', obj.dev_name, 'ch', '', 'out', 0, 'attr', h.attr);
+            if(h.ret > 0)
+                spec.ch = calllib(obj.libname, 'iio_channel_get_id', h.ch);
+                spec.out = double(calllib(obj.libname, 'iio_channel_is_output', h.ch));
+            end
+        end
+
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        %% Read a resolved attribute as a double value
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        function [ret, val] = readAttributeDoubleHandle(obj, h)
+            ret = h.ret;
+            val = 0;
+            if(ret < 0)
+                return;
+            end
+
+            % Read the attribute value
+            pData = libpointer('doublePtr', 0);
+            if(ret > 0)
+                calllib(obj.libname, 'iio_channel_attr_read_double', h.ch, h.attr, pData);
+            else
+                calllib(obj.libname, 'iio_device_attr_read_double', obj.iio_dev, h.attr, pData);
+            end
+            val = pData.Value;
+        end
+
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        %% Write a resolved attribute as a numeric value
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        function ret = writeAttributeNumberHandle(obj, h, val)
+            % Integer values are written as long long, the driver parsers
+            % of frequencies and rates do not accept a fractional part
+            if(val ~= fix(val))
+                ret = writeAttributeStringHandle(obj, h, num2str(val));
+                return;
+            end
+            ret = h.ret;
+            if(ret < 0)
+                return;
+            end
+            if(ret > 0)
+                ret = calllib(obj.libname, 'iio_channel_attr_write_longlong', h.ch, h.attr, int64(val));
+            else
+                ret = calllib(obj.libname, 'iio_device_attr_write_longlong', obj.iio_dev, h.attr, int64(val));
+            end
+        end
+
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        %% Write a resolved attribute as a string value
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        function ret = writeAttributeStringHandle(obj, h, str)
+            ret = h.ret;
+            if(ret < 0)
+                return;
+            end
+            if(ret > 0)
+                ret = calllib(obj.libname, 'iio_channel_attr_write', h.ch, h.attr, str);
+            else
+                ret = calllib(obj.libname, 'iio_device_attr_write', obj.iio_dev, h.attr, str);
+            end
+        end
+
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        %% Write a string debug attribute value
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        function ret = writeDebugAttributeString(obj, attr_name, str)
+            % Initialize the return value
+            ret = -1;
+
+            % Check if the interface is initialized
+            if(obj.if_initialized == 0)
+                return;
+            end
+
+            % Write the debug attribute
+            ret = calllib(obj.libname, 'iio_device_debug_attr_write', obj.iio_dev, attr_name, str);
+        end
+
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        %% Write a hardware register
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        function ret = writeRegister(obj, address, value)
+            % Initialize the return value
+            ret = -1;
+
+            % Check if the interface is initialized
+            if(obj.if_initialized == 0)
+                return;
+            end
+
+            % Write the register
+            ret = calllib(obj.libname, 'iio_device_reg_write', obj.iio_dev, uint32(address), uint32(value));
+        end
+
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        %% Read a hardware register
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        function [ret, val] = readRegister(obj, address)
+            % Initialize the return values
+            ret = -1;
+            val = 0;
+
+            % Check if the interface is initialized
+            if(obj.if_initialized == 0)
+                return;
+            end
+
+            % Read the register
+            pVal = libpointer('uint32Ptr', 0);
+            ret = calllib(obj.libname, 'iio_device_reg_read', obj.iio_dev, uint32(address), pVal);
+            val = pVal.Value;
+        end
+
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        %% Associate a trigger device with the device, '' removes the trigger
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        function ret = setTrigger(obj, trigger_name)
+            % Initialize the return value
+            ret = -1;
+
+            % Check if the interface is initialized
+            if(obj.if_initialized == 0)
+                return;
+            end
+
+            % Find the trigger device
+            if(isempty(trigger_name))
+                trigger = [];
+            else
+                trigger = calllib(obj.libname, 'iio_context_find_device', obj.iio_ctx, trigger_name);
+                if(isNull(trigger))
+                    return;
+                end
+                if(~calllib(obj.libname, 'iio_device_is_trigger', trigger))
+                    return;
+                end
+            end
+
+            % Set the trigger
+            ret = calllib(obj.libname, 'iio_device_set_trigger', obj.iio_dev, trigger);
+        end
+
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        %% Get the name of the trigger associated with the device
+        %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+        function [ret, trigger_name] = getTrigger(obj)
+            % Initialize the return values
+            ret = -1;
+            trigger_name = '';
+
+            % Check if the interface is initialized
+            if(obj.if_initialized == 0)
+                return;
+            end
+
+            % Get the trigger, the device may not support triggers
+            pTrigger = libpointer('iio_devicePtrPtr');
+            ret = calllib(obj.libname, 'iio_device_get_trigger', obj.iio_dev, pTrigger);
+            if(ret < 0 || isNull(pTrigger.Value))
+                return;
             end
+            trigger_name = calllib(obj.libname, 'iio_device_get_name', pTrigger.Value);
         end
     end
-end
+end
\ No newline at end of file
@@ -0,0 +1,438 @@
+/*
+ * libiio_mex.c - MEX bridge for the libiio data path of libiio_if
+ *
+ * The samples are moved between the libiio buffers and MATLAB arrays in
+ * one native pass, instead of calllib, setdatatype and strided MATLAB
+ * indexing. The MEX keeps its own context per IP address, shared by its
+ * buffers and the batched attribute reads.
+ *
+ *   h = libiio_mex('open', ip, dev_name, channels, samples, cyclic)
+ *         channels : 0-based indices of the channels to enable, the others are disabled
+ *         cyclic   : 0 capture (the buffer is created now), 1 cyclic TX (created on push)
+ *   [ch1, ch2, ...] = libiio_mex('refill', h)   one int16 column per enabled channel
+ *   x = libiio_mex('refill', h)                 I/Q as interleaved complex int16 (-R2018a)
+ *   n = libiio_mex('push', h, ch1, ch2, ...)    one column per channel, other scan elements zeroed
+ *   n = libiio_mex('push', h, x)                int16 already interleaved in scan order
+ *   libiio_mex('flush', h)                      drop the queued capture blocks, the buffer is created again
+ *   libiio_mex('ctx_open', ip)                  hold the context of ip for read_attrs
+ *   v = libiio_mex('read_attrs', ip, specs)     double attributes of specs(k).dev/ch/out/attr,
+ *                                               ch = '' for a device attribute, NaN on error
+ *   libiio_mex('ctx_close', ip)
+ *   libiio_mex('close', h)
+ *   tid = libiio_mex('tid')                     thread id of the MATLAB thread calling refill/push
+ *
+ * Build with iio_mex_build.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "mex.h"
+#include "iio.h"
+
+#define MAX_CTX 8
+#define MAX_BUF 16
+#define MAX_STR 128
+
+struct ctx_entry {
+	char ip[MAX_STR];
+	struct iio_context *ctx;
+	int refs;
+};
+
+struct buf_entry {
+	bool used;
+	int ctx;
+	struct iio_device *dev;
+	struct iio_buffer *buf;
+	size_t samples;
+	bool cyclic;
+	unsigned int ch_no;		/* Enabled channels */
+	unsigned int scan_elm_no;	/* Enabled scan elements */
+};
+
+static struct ctx_entry ctxs[MAX_CTX];
+static struct buf_entry bufs[MAX_BUF];
+
+static void get_string(const mxArray *arr, char *str, const char *what)
+{
+	if (!mxIsChar(arr) || mxGetString(arr, str, MAX_STR))
+		mexErrMsgIdAndTxt("libiio_mex:arg", "%s must be a string", what);
+}
+
+static int get_ctx(const char *ip)
+{
+	int i, free_slot = -1;
+
+	for (i = 0; i < MAX_CTX; i++) {
+		if (ctxs[i].refs > 0 && !strcmp(ctxs[i].ip, ip)) {
+			ctxs[i].refs++;
+			return i;
+		}
+		if (ctxs[i].refs == 0 && free_slot < 0)
+			free_slot = i;
+	}
+	if (free_slot < 0)
+		mexErrMsgIdAndTxt("libiio_mex:ctx", "Too many contexts");
+
+	ctxs[free_slot].ctx = iio_create_network_context(ip);
+	if (!ctxs[free_slot].ctx)
+		mexErrMsgIdAndTxt("libiio_mex:ctx", "Could not connect to the IIO server %s", ip);
+	strncpy(ctxs[free_slot].ip, ip, MAX_STR - 1);
+	ctxs[free_slot].refs = 1;
+	return free_slot;
+}
+
+static int find_ctx(const char *ip)
+{
+	int i;
+
+	for (i = 0; i < MAX_CTX; i++)
+		if (ctxs[i].refs > 0 && !strcmp(ctxs[i].ip, ip))
+			return i;
+	return -1;
+}
+
+static void put_ctx(int i)
+{
+	if (--ctxs[i].refs == 0) {
+		iio_context_destroy(ctxs[i].ctx);
+		ctxs[i].ctx = NULL;
+	}
+}
+
+static struct buf_entry *get_buf(int nrhs, const mxArray *prhs[])
+{
+	double val;
+	int h;
+
+	if (nrhs < 2 || !mxIsDouble(prhs[1]) || mxIsComplex(prhs[1]) ||
+	    mxGetNumberOfElements(prhs[1]) != 1)
+		mexErrMsgIdAndTxt("libiio_mex:handle", "Missing handle");
+	/* Checked before the cast, a NaN or out of range double has no int value */
+	val = mxGetScalar(prhs[1]);
+	if (!isfinite(val) || val < 1 || val > MAX_BUF)
+		mexErrMsgIdAndTxt("libiio_mex:handle", "Invalid handle");
+	h = (int)val - 1;
+
+	if (!bufs[h].used)
+		mexErrMsgIdAndTxt("libiio_mex:handle", "Invalid handle");
+	return &bufs[h];
+}
+
+static void close_buf(struct buf_entry *b)
+{
+	if (b->buf)
+		iio_buffer_destroy(b->buf);
+	b->buf = NULL;
+	put_ctx(b->ctx);
+	b->used = false;
+}
+
+static void cleanup(void)
+{
+	int i;
+
+	for (i = 0; i < MAX_BUF; i++)
+		if (bufs[i].used)
+			close_buf(&bufs[i]);
+}
+
+static void cmd_open(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+	char ip[MAX_STR], name[MAX_STR];
+	const double *ch_idx;
+	size_t n_idx, k;
+	unsigned int i, nb_channels;
+	struct buf_entry *b = NULL;
+	int h;
+
+	if (nrhs != 6)
+		mexErrMsgIdAndTxt("libiio_mex:arg", "open : ip, dev_name, channels, samples, cyclic");
+	get_string(prhs[1], ip, "ip");
+	get_string(prhs[2], name, "dev_name");
+	if (!mxIsDouble(prhs[3]) || mxIsComplex(prhs[3]))
+		mexErrMsgIdAndTxt("libiio_mex:arg", "channels must be real double indices");
+	ch_idx = mxGetPr(prhs[3]);
+	n_idx = mxGetNumberOfElements(prhs[3]);
+	for (k = 0; k < n_idx; k++)
+		if (!isfinite(ch_idx[k]) || ch_idx[k] < 0)
+			mexErrMsgIdAndTxt("libiio_mex:arg", "channels must be 0-based indices");
+	if (!mxIsDouble(prhs[4]) || mxIsComplex(prhs[4]) || mxGetNumberOfElements(prhs[4]) != 1 ||
+	    !isfinite(mxGetScalar(prhs[4])) || mxGetScalar(prhs[4]) < 1)
+		mexErrMsgIdAndTxt("libiio_mex:arg", "samples must be a positive real scalar");
+
+	for (h = 0; h < MAX_BUF; h++) {
+		if (!bufs[h].used) {
+			b = &bufs[h];
+			break;
+		}
+	}
+	if (!b)
+		mexErrMsgIdAndTxt("libiio_mex:handle", "Too many buffers");
+
+	memset(b, 0, sizeof(*b));
+	b->ctx = get_ctx(ip);
+	b->dev = iio_context_find_device(ctxs[b->ctx].ctx, name);
+	if (!b->dev) {
+		put_ctx(b->ctx);
+		mexErrMsgIdAndTxt("libiio_mex:dev", "Device %s not found", name);
+	}
+
+	/* Enable the requested channels only */
+	nb_channels = iio_device_get_channels_count(b->dev);
+	for (i = 0; i < nb_channels; i++) {
+		struct iio_channel *chn = iio_device_get_channel(b->dev, i);
+		bool enable = false;
+
+		for (k = 0; k < n_idx; k++)
+			enable |= ((unsigned int)ch_idx[k] == i);
+		if (enable) {
+			iio_channel_enable(chn);
+			b->ch_no++;
+			if (iio_channel_is_scan_element(chn))
+				b->scan_elm_no++;
+		} else {
+			iio_channel_disable(chn);
+		}
+	}
+
+	b->samples = (size_t)mxGetScalar(prhs[4]);
+	b->cyclic = mxGetScalar(prhs[5]) != 0;
+	if (!b->cyclic) {
+		b->buf = iio_device_create_buffer(b->dev, b->samples, false);
+		if (!b->buf) {
+			put_ctx(b->ctx);
+			mexErrMsgIdAndTxt("libiio_mex:buf", "Could not create the buffer of %s", name);
+		}
+	}
+	b->used = true;
+	plhs[0] = mxCreateDoubleScalar(h + 1);
+}
+
+static void cmd_refill(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+	struct buf_entry *b = get_buf(nrhs, prhs);
+	const int16_t *src;
+	ptrdiff_t step;
+	size_t n, k;
+	int c;
+
+	if (b->cyclic || !b->buf || iio_buffer_refill(b->buf) < 0)
+		mexErrMsgIdAndTxt("libiio_mex:refill", "Refill failed");
+
+	src = iio_buffer_start(b->buf);
+	step = iio_buffer_step(b->buf) / sizeof(int16_t);
+	n = ((const int16_t *)iio_buffer_end(b->buf) - src) / step;
+
+	if (nlhs <= 1 && b->ch_no == 2) {
+#if MX_HAS_INTERLEAVED_COMPLEX
+		/* I/Q pairs are the complex int16 layout of MATLAB */
+		mxComplexInt16 *dst;
+
+		plhs[0] = mxCreateNumericMatrix(n, 1, mxINT16_CLASS, mxCOMPLEX);
+		dst = mxGetComplexInt16s(plhs[0]);
+		if (step == 2) {
+			memcpy(dst, src, n * sizeof(*dst));
+		} else {
+			for (k = 0; k < n; k++) {
+				dst[k].real = src[k * step];
+				dst[k].imag = src[k * step + 1];
+			}
+		}
+		return;
+#else
+		mexErrMsgIdAndTxt("libiio_mex:refill", "Complex output needs the -R2018a build");
+#endif
+	}
+
+	/* One column per channel, de-interleaved in a single pass */
+	for (c = 0; c < nlhs && c < (int)b->ch_no; c++) {
+		int16_t *dst;
+
+		plhs[c] = mxCreateNumericMatrix(n, 1, mxINT16_CLASS, mxREAL);
+		dst = (int16_t *)mxGetData(plhs[c]);
+		for (k = 0; k < n; k++)
+			dst[k] = src[k * step + c];
+	}
+}
+
+/* Rounds and saturates like int16() in MATLAB */
+static int16_t to_int16(double x)
+{
+	if (isnan(x))
+		return 0;
+	if (x >= INT16_MAX)
+		return INT16_MAX;
+	if (x <= INT16_MIN)
+		return INT16_MIN;
+	return (int16_t)lround(x);
+}
+
+static void cmd_flush(int nrhs, const mxArray *prhs[])
+{
+	struct buf_entry *b = get_buf(nrhs, prhs);
+
+	if (b->cyclic)
+		mexErrMsgIdAndTxt("libiio_mex:flush", "flush : capture handle");
+
+	/* Destroying the buffer stops the DMA and frees the blocks already queued */
+	iio_buffer_destroy(b->buf);
+	b->buf = iio_device_create_buffer(b->dev, b->samples, false);
+	if (!b->buf)
+		mexErrMsgIdAndTxt("libiio_mex:buf", "Could not create the capture buffer");
+}
+
+static void cmd_push(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+	struct buf_entry *b;
+	size_t total, k;
+	int16_t *dst;
+	int c;
+	ssize_t ret;
+
+	if (nrhs < 3)
+		mexErrMsgIdAndTxt("libiio_mex:push", "push : TX handle and data");
+	b = get_buf(nrhs, prhs);
+	if (!b->cyclic)
+		mexErrMsgIdAndTxt("libiio_mex:push", "push : TX handle and data");
+
+	/* A cyclic buffer is transmitted until destroyed, a new one is created per push */
+	if (b->buf)
+		iio_buffer_destroy(b->buf);
+	b->buf = iio_device_create_buffer(b->dev, b->samples, true);
+	if (!b->buf)
+		mexErrMsgIdAndTxt("libiio_mex:buf", "Could not create the TX buffer");
+
+	dst = iio_buffer_start(b->buf);
+	total = b->samples * b->scan_elm_no;
+	if (nrhs == 3 && mxIsInt16(prhs[2]) && mxGetNumberOfElements(prhs[2]) == total) {
+		/* Already interleaved in scan element order */
+		memcpy(dst, mxGetData(prhs[2]), total * sizeof(int16_t));
+	} else {
+		memset(dst, 0, total * sizeof(int16_t));
+		for (c = 0; c < nrhs - 2 && c < (int)b->scan_elm_no; c++) {
+			const mxArray *arr = prhs[c + 2];
+			size_t n = mxGetNumberOfElements(arr);
+
+			if (n > b->samples)
+				n = b->samples;
+			if (mxIsInt16(arr)) {
+				const int16_t *src = (const int16_t *)mxGetData(arr);
+
+				for (k = 0; k < n; k++)
+					dst[k * b->scan_elm_no + c] = src[k];
+			} else if (mxIsDouble(arr) && !mxIsComplex(arr)) {
+				const double *src = mxGetPr(arr);
+
+				for (k = 0; k < n; k++)
+					dst[k * b->scan_elm_no + c] = to_int16(src[k]);
+			} else {
+				mexErrMsgIdAndTxt("libiio_mex:push", "Channel data must be real int16 or double");
+			}
+		}
+	}
+
+	ret = iio_buffer_push(b->buf);
+	if (ret < 0)
+		mexErrMsgIdAndTxt("libiio_mex:push", "Push failed (%d)", (int)ret);
+	plhs[0] = mxCreateDoubleScalar((double)ret);
+}
+
+static void cmd_read_attrs(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+	char ip[MAX_STR], dev_name[MAX_STR], ch_name[MAX_STR], attr[MAX_STR];
+	const mxArray *specs;
+	struct iio_context *ctx;
+	size_t n, k;
+	double *vals;
+	int i;
+
+	if (nrhs != 3 || !mxIsStruct(prhs[2]))
+		mexErrMsgIdAndTxt("libiio_mex:arg", "read_attrs : ip, specs");
+	get_string(prhs[1], ip, "ip");
+	specs = prhs[2];
+	n = mxGetNumberOfElements(specs);
+
+	/* The context is held by ctx_open or by a buffer, not per call */
+	i = find_ctx(ip);
+	if (i < 0)
+		mexErrMsgIdAndTxt("libiio_mex:ctx", "No context open for %s", ip);
+	ctx = ctxs[i].ctx;
+
+	plhs[0] = mxCreateDoubleMatrix(n, 1, mxREAL);
+	vals = mxGetPr(plhs[0]);
+	for (k = 0; k < n; k++) {
+		const struct iio_device *dev;
+		const mxArray *out = mxGetField(specs, k, "out");
+
+		vals[k] = NAN;
+		get_string(mxGetField(specs, k, "dev"), dev_name, "specs.dev");
+		get_string(mxGetField(specs, k, "ch"), ch_name, "specs.ch");
+		get_string(mxGetField(specs, k, "attr"), attr, "specs.attr");
+		dev = iio_context_find_device(ctx, dev_name);
+		if (!dev)
+			continue;
+		if (ch_name[0] == '\0') {
+			iio_device_attr_read_double(dev, attr, &vals[k]);
+		} else {
+			const struct iio_channel *chn = iio_device_find_channel(dev, ch_name,
+					out && mxGetScalar(out) != 0);
+
+			if (chn)
+				iio_channel_attr_read_double(chn, attr, &vals[k]);
+		}
+	}
+}
+
+static void cmd_ctx(int nrhs, const mxArray *prhs[], bool open)
+{
+	char ip[MAX_STR];
+	int i;
+
+	if (nrhs != 2)
+		mexErrMsgIdAndTxt("libiio_mex:arg", "ctx_open/ctx_close : ip");
+	get_string(prhs[1], ip, "ip");
+	if (open) {
+		get_ctx(ip);
+	} else {
+		i = find_ctx(ip);
+		if (i >= 0)
+			put_ctx(i);
+	}
+}
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+	char cmd[MAX_STR];
+
+	mexAtExit(cleanup);
+	if (nrhs < 1)
+		mexErrMsgIdAndTxt("libiio_mex:arg", "Missing command");
+	get_string(prhs[0], cmd, "command");
+
+	if (!strcmp(cmd, "open")) {
+		cmd_open(nlhs, plhs, nrhs, prhs);
+	} else if (!strcmp(cmd, "refill")) {
+		cmd_refill(nlhs, plhs, nrhs, prhs);
+	} else if (!strcmp(cmd, "push")) {
+		cmd_push(nlhs, plhs, nrhs, prhs);
+	} else if (!strcmp(cmd, "flush")) {
+		cmd_flush(nrhs, prhs);
+	} else if (!strcmp(cmd, "read_attrs")) {
+		cmd_read_attrs(nlhs, plhs, nrhs, prhs);
+	} else if (!strcmp(cmd, "ctx_open")) {
+		cmd_ctx(nrhs, prhs, true);
+	} else if (!strcmp(cmd, "ctx_close")) {
+		cmd_ctx(nrhs, prhs, false);
+	} else if (!strcmp(cmd, "close")) {
+		close_buf(get_buf(nrhs, prhs));
+	} else if (!strcmp(cmd, "tid")) {
+		plhs[0] = mxCreateDoubleScalar((double)syscall(SYS_gettid));
+	} else {
+		mexErrMsgIdAndTxt("libiio_mex:arg", "Unknown command %s", cmd);
+	}
+}